@@ -0,0 +1,116 @@
+// Includes
+    #include "bitboard.h"
+    #include <stdlib.h>
+    #include <string.h>
+
+//--------------------------------------------------------------------------------------
+// Lifetime
+//--------------------------------------------------------------------------------------
+    bool InitBitboard(Bitboard *board, int width, int height) {
+        board->width = width;
+        board->height = height;
+        board->wordsPerRow = (width + 63) / 64;
+        board->words = calloc((size_t)board->wordsPerRow * height, sizeof(uint64_t));
+        return board->words != NULL;
+    }
+
+    void FreeBitboard(Bitboard *board) {
+        free(board->words);
+        board->words = NULL;
+    }
+
+    void ClearBitboard(Bitboard *board) {
+        memset(board->words, 0, sizeof(uint64_t) * board->wordsPerRow * board->height);
+    }
+
+//--------------------------------------------------------------------------------------
+// Queries
+//--------------------------------------------------------------------------------------
+    static inline uint64_t UnionWord(const Bitboard *a, const Bitboard *b, int y, int w) {
+        int i = y * a->wordsPerRow + w;
+        return a->words[i] | b->words[i];
+    }
+
+    // Cells x-1, x and x+1 of row y in a | b as bits 0..2, with cells off the board set. One shift
+    // of the word holding x, plus a bit from the word beside it when x sits at either end of a word.
+    static inline unsigned RowWindow(const Bitboard *a, const Bitboard *b, int x, int y) {
+        if (y < 0 || y >= a->height) return 7;
+        int w = x >> 6;
+        int bit = x & 63;
+        uint64_t word = UnionWord(a, b, y, w);
+        unsigned window;
+        if (bit > 0) {
+            window = (unsigned)(word >> (bit - 1)) & 7;
+        } else {
+            window = ((unsigned)(word << 1) & 6) | (w > 0 ? (unsigned)(UnionWord(a, b, y, w - 1) >> 63) : 1);
+        }
+        if (bit == 63) window |= (w + 1 < a->wordsPerRow ? (unsigned)(UnionWord(a, b, y, w + 1) & 1) : 1) << 2;
+        if (x == a->width - 1) window |= 4; // Bits past the right edge are always clear
+        return window;
+    }
+
+    int BitboardNeighbourMask(const Bitboard *a, const Bitboard *b, int x, int y) {
+        unsigned above = RowWindow(a, b, x, y - 1);
+        unsigned row = RowWindow(a, b, x, y);
+        unsigned below = RowWindow(a, b, x, y + 1);
+        return ((above >> 1) & 1) | ((row >> 1) & 2) | ((below << 1) & 4) | ((row & 1) << 3);
+    }
+
+//--------------------------------------------------------------------------------------
+// Dilation
+//--------------------------------------------------------------------------------------
+    // Spreads each row sideways by one cell (carrying bits across word boundaries) and ORs in the
+    // rows above and below, spread too for the 8-neighbourhood and left as they are for the cross
+    static void DilateRows(const Bitboard *src, Bitboard *dst, bool diagonal) {
+        int words = src->wordsPerRow;
+        // Bits past the right edge of the last word must stay clear
+        uint64_t lastWordMask = (src->width & 63) ? ((uint64_t)1 << (src->width & 63)) - 1 : ~(uint64_t)0;
+
+        // Grids up to 64 wide fit a row in one word, so there is nothing to carry between words
+        if (words == 1) {
+            const uint64_t *r = src->words;
+            for (int y = 0; y < src->height; y++) {
+                uint64_t row = r[y] | (r[y] << 1) | (r[y] >> 1);
+                uint64_t above = (y > 0) ? r[y - 1] : 0;
+                uint64_t below = (y + 1 < src->height) ? r[y + 1] : 0;
+                uint64_t vertical = above | below;
+                if (diagonal) vertical |= (vertical << 1) | (vertical >> 1);
+                dst->words[y] = (row | vertical) & lastWordMask;
+            }
+            return;
+        }
+
+        for (int y = 0; y < src->height; y++) {
+            for (int w = 0; w < words; w++) {
+                uint64_t spread = 0;
+                for (int dy = -1; dy <= 1; dy++) {
+                    int row = y + dy;
+                    if (row < 0 || row >= src->height) continue;
+                    const uint64_t *r = &src->words[row * words];
+                    spread |= r[w];
+                    if (dy != 0 && !diagonal) continue;
+                    uint64_t towardsEast = (r[w] << 1) | (w > 0 ? r[w - 1] >> 63 : 0);
+                    uint64_t towardsWest = (r[w] >> 1) | (w + 1 < words ? r[w + 1] << 63 : 0);
+                    spread |= towardsEast | towardsWest;
+                }
+                if (w == words - 1) spread &= lastWordMask;
+                dst->words[y * words + w] = spread;
+            }
+        }
+    }
+
+    void BitboardDilate(const Bitboard *src, Bitboard *dst) {
+        DilateRows(src, dst, true);
+    }
+
+    void BitboardDilateCross(const Bitboard *src, Bitboard *dst) {
+        DilateRows(src, dst, false);
+    }
+
+    void BitboardDistanceLevels(const Bitboard *src, Bitboard *levels, int count, bool diagonal) {
+        if (count <= 0) return;
+        memcpy(levels[0].words, src->words, sizeof(uint64_t) * src->wordsPerRow * src->height);
+        for (int k = 1; k < count; k++) {
+            DilateRows(&levels[k - 1], &levels[k], diagonal);
+        }
+    }
@@ -0,0 +1,50 @@
+// Bitboard
+// One bit per grid cell, packed row by row into 64-bit words, so a whole row of a cell type
+// can be tested, shifted or combined in a handful of word operations.
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+    #include <stdbool.h>
+    #include <stdint.h>
+
+    typedef struct {
+        int width, height;
+        int wordsPerRow;
+        uint64_t *words; // Row y starts at words[y * wordsPerRow]; cell (x, y) is bit x % 64 of word x / 64
+    } Bitboard;
+
+    // Allocates a cleared board for a width x height grid. Returns false if malloc() fails.
+    bool InitBitboard(Bitboard *board, int width, int height);
+    void FreeBitboard(Bitboard *board);
+    void ClearBitboard(Bitboard *board);
+
+    static inline bool BitboardTest(const Bitboard *board, int x, int y) {
+        return (board->words[y * board->wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    static inline void BitboardSet(Bitboard *board, int x, int y) {
+        board->words[y * board->wordsPerRow + (x >> 6)] |= (uint64_t)1 << (x & 63);
+    }
+
+    static inline void BitboardReset(Bitboard *board, int x, int y) {
+        board->words[y * board->wordsPerRow + (x >> 6)] &= ~((uint64_t)1 << (x & 63));
+    }
+
+    // Bit d of the result is set if the neighbour in direction d (0 north/-y, 1 east/+x,
+    // 2 south/+y, 3 west/-x) is set in a or b, or lies off the board. Reads a 3-cell window of
+    // a | b from each of the three rows rather than testing cells one at a time. Pass the same
+    // board twice to ask about one board.
+    int BitboardNeighbourMask(const Bitboard *a, const Bitboard *b, int x, int y);
+
+    // dst = every cell within one step (8-neighbourhood) of a set cell in src, including the cell itself.
+    // Both boards must be the same size and must not be the same board.
+    void BitboardDilate(const Bitboard *src, Bitboard *dst);
+    // As BitboardDilate, but only stepping to the 4 edge neighbours
+    void BitboardDilateCross(const Bitboard *src, Bitboard *dst);
+
+    // Distance transform by repeated dilation: levels[k] = cells within k steps of a set cell in src,
+    // for k = 0 .. count-1. Steps go to the 4 edge neighbours (Manhattan distance), or to all 8 if
+    // diagonal (Chebyshev distance). Each level costs a few word operations per 64 cells.
+    void BitboardDistanceLevels(const Bitboard *src, Bitboard *levels, int count, bool diagonal);
+
+#endif
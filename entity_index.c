@@ -0,0 +1,85 @@
+// Includes
+    #include "entity_index.h"
+    #include <stdlib.h>
+    #include <string.h>
+
+//--------------------------------------------------------------------------------------
+// Lifetime
+//--------------------------------------------------------------------------------------
+    bool InitEntityIndex(EntityIndex *index, int maxEntities) {
+        // At most half full, so probe runs stay short
+        int bits = 1;
+        while ((1 << bits) < 2 * maxEntities) bits++;
+        index->capacity = 1 << bits;
+        index->shift = 32 - bits;
+        index->count = 0;
+        index->keys = calloc(index->capacity, sizeof(uint32_t));
+        index->entities = malloc(sizeof(int) * index->capacity);
+        if (index->keys == NULL || index->entities == NULL) {
+            FreeEntityIndex(index);
+            return false;
+        }
+        return true;
+    }
+
+    void FreeEntityIndex(EntityIndex *index) {
+        free(index->keys);
+        free(index->entities);
+        index->keys = NULL;
+        index->entities = NULL;
+        index->capacity = 0;
+        index->count = 0;
+    }
+
+    void ClearEntityIndex(EntityIndex *index) {
+        index->count = 0;
+        if (index->keys == NULL) return; // Not allocated yet, so already empty
+        memset(index->keys, 0, sizeof(uint32_t) * index->capacity);
+    }
+
+//--------------------------------------------------------------------------------------
+// Lookups
+//--------------------------------------------------------------------------------------
+    // Fibonacci hashing: the top bits of key * 2^32/phi spread neighbouring cells across the table
+    static inline int HomeSlot(const EntityIndex *index, uint32_t key) {
+        return (int)((key * 2654435769u) >> index->shift);
+    }
+
+    // The slot holding key, or the empty slot where its probe run ends
+    static int FindSlot(const EntityIndex *index, uint32_t key) {
+        int mask = index->capacity - 1;
+        int slot = HomeSlot(index, key);
+        while (index->keys[slot] != 0 && index->keys[slot] != key) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    int EntityIndexFind(const EntityIndex *index, int cell) {
+        int slot = FindSlot(index, (uint32_t)cell + 1);
+        return index->keys[slot] != 0 ? index->entities[slot] : ENTITY_INDEX_NONE;
+    }
+
+    void EntityIndexInsert(EntityIndex *index, int cell, int entity) {
+        uint32_t key = (uint32_t)cell + 1;
+        int slot = FindSlot(index, key);
+        if (index->keys[slot] == 0) index->count++;
+        index->keys[slot] = key;
+        index->entities[slot] = entity;
+    }
+
+    // Backward-shift deletion: later entries of the run move up into the hole, so lookups never
+    // need tombstones and the table doesn't degrade as entities keep moving
+    void EntityIndexRemove(EntityIndex *index, int cell) {
+        int mask = index->capacity - 1;
+        int hole = FindSlot(index, (uint32_t)cell + 1);
+        if (index->keys[hole] == 0) return;
+        index->count--;
+        for (int slot = (hole + 1) & mask; index->keys[slot] != 0; slot = (slot + 1) & mask) {
+            // An entry may fill the hole only if the hole lies between its home slot and where it sits
+            int home = HomeSlot(index, index->keys[slot]);
+            if (((slot - home) & mask) < ((slot - hole) & mask)) continue;
+            index->keys[hole] = index->keys[slot];
+            index->entities[hole] = index->entities[slot];
+            hole = slot;
+        }
+        index->keys[hole] = 0;
+    }
@@ -0,0 +1,32 @@
+// Entity Index
+// Which entity stands on a cell, for the few cells that hold one. An open-addressing hash table
+// keyed on the cell's row-major index and sized to the number of entities rather than the arena,
+// so a lookup is O(1) and costs the same on a 30x30 grid as on a 10000x10000 one.
+#ifndef ENTITY_INDEX_H
+#define ENTITY_INDEX_H
+
+    #include <stdbool.h>
+    #include <stdint.h>
+
+    #define ENTITY_INDEX_NONE -1
+
+    typedef struct {
+        uint32_t *keys; // Cell index + 1, 0 marks an empty slot
+        int *entities;
+        int capacity; // Slots, a power of two at least twice the entities it was sized for
+        int shift; // 32 - log2(capacity), for the multiplicative hash
+        int count;
+    } EntityIndex;
+
+    // Sizes the table for up to maxEntities entries. Returns false if malloc() fails.
+    bool InitEntityIndex(EntityIndex *index, int maxEntities);
+    void FreeEntityIndex(EntityIndex *index);
+    void ClearEntityIndex(EntityIndex *index);
+
+    // The entity on cell, or ENTITY_INDEX_NONE
+    int EntityIndexFind(const EntityIndex *index, int cell);
+    // cell must not be in the table yet, and the table must have been sized for the new entry
+    void EntityIndexInsert(EntityIndex *index, int cell, int entity);
+    void EntityIndexRemove(EntityIndex *index, int cell);
+
+#endif
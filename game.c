@@ -6,25 +6,99 @@
     #include <stdio.h> // For sprintf, file handling
     #include <string.h> // For strings
     #include <ctype.h> // For isalnum()
+    #include <time.h> // For clock_gettime(), which works without a window
+    #include <stdint.h>
+    #include <pthread.h> // Batch runs play games on several threads
+    #include <unistd.h> // For sysconf(), to count cores
+    #include "bitboard.h"
+    #include "world.h"
+    #include "entity_index.h"
 
 //--------------------------------------------------------------------------------------
 // Constants & Definitions
 //--------------------------------------------------------------------------------------
-    #define GRID_WIDTH 30
-    #define GRID_HEIGHT 30
+    #define DEFAULT_GRID_WIDTH 30
+    #define DEFAULT_GRID_HEIGHT 30
+    #define MIN_GRID_SIDE 10 // Room for the starting walls, the robot's spawn and one HPA cluster
+    #define MAX_GRID_SIDE 10000 // The world itself is sparse, so only the tile directory grows with the arena
+    #define AI_WINDOW_SIDE 128 // The planners see at most this many cells a side, around the robot
+    #define AI_WINDOW_MARGIN 32 // Cells the robot keeps from an edge of the window that isn't the arena's
     #define CELL_SIZE 2.0f
     #define MAX_LIVES 5
     #define NUM_PEOPLE 5
-    #define BATTERY_RADIUS (GRID_WIDTH * CELL_SIZE * 0.8f)    
+    #define BATTERY_RADIUS(gridWidth) ((gridWidth) * CELL_SIZE * 0.8f)
+    #define CELLS_PER_MINE_CAP 18 // Mine counts stop growing at one per this many cells, 50 on the default arena
     #define MAX_LEADERBOARD_ENTRIES 100
     #define LEADERBOARD_DISPLAY_LIMIT 5
-    #define MAX_PATH_LENGTH (GRID_WIDTH * GRID_HEIGHT) // for weighted A* algo path
+    #define PATH_COST_INFINITY 1000000 // Cost of entering a wall or mine, and of unreachable cells
+    #define MINE_SAFETY_RADIUS 4 // Fallback moves only count mines inside this window (Chebyshev)
+    #define MAX_DIRTY_CELLS 256 // Grid writes remembered between AI ticks before giving up and replanning fully
+    #define HPA_CLUSTER_SIZE 10 // Side length of a hierarchical pathfinding cluster, in cells
+    #define HPA_SLOTS_PER_CLUSTER (4 * HPA_CLUSTER_SIZE) // One possible entrance per border cell, per side
+    #define SEARCH_NODE_BUDGET 128 // Default A* expansions per frame when the search is budgeted
+    #define SEARCH_TIME_BUDGET_US 250 // Default A* microseconds per frame when the search is budgeted
+    #define FRAME_TIME_SAMPLES 600 // Gameplay update times kept for the p99 readout (10s at 60fps)
+    #define ARA_TIME_BUDGET 0.001 // Seconds ARA* may spend tightening its path each tick, after the first path
+    #define ARA_WEIGHT_STEP 0.25f // How much ARA* lowers the heuristic weight between passes
+    #define SPACETIME_HORIZON 8 // Robot moves looked ahead by the space-time planner
+    #define SPACETIME_BOX_SIDE (2 * SPACETIME_HORIZON + 1) // Every cell the robot can reach within the horizon
+    #define SPACETIME_MAX_FRAMES 90 // Frames of mine motion predicted, caps the horizon when the robot is slow
+    #define SPACETIME_MAX_MINE_STATES 24 // Most likely (cell, direction) states tracked per mine
+    #define SPACETIME_RISK_THRESHOLD 0.2f // Highest total collision chance an accepted path may carry
+    #define SPACETIME_RISK_COST 100.0f // Path cost charged per unit of collision chance
+    #define SPACETIME_TIME_BUDGET 0.002 // Seconds the space-time planner may spend per tick
+    #define RESCUE_HELD_KARP_MAX 10 // Largest group ordered exactly, Held-Karp is 2^n * n^2
+    #define RESCUE_HELD_KARP_PEOPLE (NUM_PEOPLE < RESCUE_HELD_KARP_MAX ? NUM_PEOPLE : RESCUE_HELD_KARP_MAX)
+    #define RESCUE_REPLAN_DISTANCE 3 // Cells a person may drift from where the tour was planned before it is redone
+    #define DEFAULT_TICK_RATE 60 // Simulation ticks per second at level 1. Movement odds and cooldowns are all per tick.
+    #define MAX_TICK_RATE 1000
+    #define MAX_TICKS_PER_FRAME 10 // A frame slower than this many ticks drops the rest rather than spiralling
+    #define RENDER_FPS 60
+    #define DEFAULT_HEADLESS_LEVELS 10
+    #define HEADLESS_LEVEL_TIMEOUT 600.0 // Simulated seconds before a headless level counts as stuck
+    #define REPLAY_VERSION 2
+    #define REPLAY_CHECKSUM_INTERVAL 60 // Ticks between state checksums in a replay, one a second at level 1
+    #define REPLAY_BUDGET_QUEUE 8 // Time budgets a replay can have run out within one tick
+
+    // Per-cell arrays are row-major, so walking x along a row stays within a cache line
+    static inline int CellIndex(int width, int x, int y) {
+        return y * width + x;
+    }
+
+    // A cell of the grid. The simulation works in these, Vector2 only appears when drawing.
+    typedef struct {
+        int16_t x, y;
+    } GridPos;
     
     typedef struct {
         char name[20];
         int level;
         int duration; // seconds
     } ScoreEntry;
+
+    typedef struct {
+        bool processed; // This game's score is saved and the table loaded
+        ScoreEntry topScores[MAX_LEADERBOARD_ENTRIES];
+        int totalScoresLoaded;
+        int currentRunDuration;
+    } GameOverScreen;
+
+    // PCG32 (pcg-random.org): a 64-bit LCG whose output is permuted down to 32 bits. Integer-only,
+    // so every platform draws the same numbers, and each increment is a separate stream.
+    typedef struct {
+        uint64_t state;
+        uint64_t increment; // Always odd, picks the stream
+    } GameRandom;
+
+    // Streams under one level's seed (see SeedLevelRandom). People and mines take alternate
+    // streams so neither count shifts the other's.
+    #define RANDOM_STREAM_LAYOUT 0
+    #define RANDOM_STREAM_ROBOT 1
+    #define RANDOM_STREAM_PERSON(i) (2 + 2 * (uint64_t)(i))
+    #define RANDOM_STREAM_MINE(i) (3 + 2 * (uint64_t)(i))
+
+    #define ENTITY_CHANCE_ONE 32768 // Entity chances are 15-bit fixed point, see RollEntityPool
+    #define ENTITY_DISABLED -1
     
     typedef struct {
         int x, y;
@@ -34,8 +108,200 @@
         int parentX, parentY; // For retracing the path
         bool closed; // If true, node has been evaluated, if false, 
         bool open;   // If true, node is in the queue to be evaluated
+        int heapIndex; // Slot in the open set heap, -1 when not queued
+        unsigned int generation; // Search that last initialised this node
     } Node; // Just for A* pathfinding
 
+    // One bit per window cell for each cell type the AI asks about, mirroring ctx->world
+    typedef struct {
+        Bitboard wall, mine, person, robot;
+        // Distance transform of the mines by repeated dilation, refreshed each AI tick. [1] of the
+        // Chebyshev levels is "next to a mine", the whole set scores the fallback's moves.
+        Bitboard mineChebyshev[MINE_SAFETY_RADIUS + 1]; // [k]: within k steps of a mine, diagonals allowed
+        Bitboard mineManhattan[2 * MINE_SAFETY_RADIUS + 1]; // [k]: within k edge steps of a mine
+    } GridBitboards;
+
+    // Remembers which planner produced ctx->currentPath and for which target, so the rest of the path
+    // can be reused next tick if nothing on or beside it has changed
+    typedef struct {
+        bool valid;
+        int planner;
+        int targetX, targetY;
+        int hits, misses;
+    } PathCache;
+
+    // Binary min-heap of open nodes ordered by fCost. Each node remembers its own
+    // slot (heapIndex) so a cheaper route can be re-sifted in place (decrease-key)
+    typedef struct {
+        Node** items; // Allocated by InitOpenSet, one slot per node the owning search can hold
+        int count;
+        int capacity;
+    } OpenSet;
+
+    // Node storage reused across searches. Rather than resetting every node up front,
+    // each search bumps the generation and a node is reset the first time it is touched
+    typedef struct {
+        Node *nodes; // One per cell, row-major (see CellIndex)
+        int width, height;
+        OpenSet openSet;
+        unsigned int generation;
+
+        // Resumable A*: the query being searched and how far it has got
+        bool searchActive; // Cleared by BeginSearch, so another planner using the workspace cancels it
+        bool searchFinished;
+        int startX, startY, targetX, targetY;
+        Node *bestNode; // Expanded node nearest the target, followed while the search is unfinished
+        Node *goalNode; // NULL until the target is reached
+    } SearchWorkspace;
+
+    // Cells written since the AI last looked, so incremental planners only repair what changed
+    typedef struct {
+        int x[MAX_DIRTY_CELLS];
+        int y[MAX_DIRTY_CELLS];
+        int count;
+        bool overflowed; // Too many writes to list (or a whole-grid change): treat every cell as changed
+    } DirtyCells;
+
+    // D* Lite state, kept between ticks. It searches backwards from the target so that the
+    // robot moving only shifts the heuristic (keyModifier) instead of invalidating the search.
+    typedef struct {
+        Node *nodes; // gCost = cost-to-target, fCost/hCost = the two-part queue key
+        int *rhs;    // One-step lookahead of gCost
+        int *cost;   // Entry costs the current values were computed with
+        int width, height;
+        OpenSet queue;
+        int startX, startY;
+        int goalX, goalY;
+        int keyModifier; // km in the D* Lite paper
+        bool initialised;
+    } DStarLite;
+
+    // Jump Point Search tables. Jump distances only depend on walls, so they are rebuilt when a
+    // wall changes. Mines move every frame, so they are covered by a per-search hazard count instead.
+    typedef struct {
+        // Vertical jump distance per cell, [0] = NORTH, [1] = SOUTH. Positive: steps to the next
+        // cell with a wall-forced neighbour. Zero or negative: -(free steps before hitting a wall).
+        int *jumpDistance[2];
+        // Per column running count of mine / near-mine cells, height + 1 entries per column:
+        // rows [a, b] of column x hold column[b + 1] - column[a], where column = &hazardPrefix[x * (height + 1)]
+        int *hazardPrefix;
+        bool tablesStale; // Set whenever a wall is painted, erased or the level changes
+        bool hazardsStale; // Set whenever a mine moves, appears or goes, or the level changes
+    } JumpPointTables;
+
+    // HPA* abstraction over the walls: clusters, the entrances between them and cached
+    // distances between entrances of the same cluster. Slot (side, pos) is the border cell
+    // pos along that side, so the matching entrance next door is always (opposite side, pos).
+    // Clusters are numbered row-major, cluster = cy * clustersX + cx.
+    typedef struct {
+        int clustersX, clustersY;
+        int nodeCount; // One per slot of every cluster
+        bool *active; // [cluster * HPA_SLOTS_PER_CLUSTER + slot]
+        short *distance; // [(cluster * HPA_SLOTS_PER_CLUSTER + from) * HPA_SLOTS_PER_CLUSTER + to], -1 if unreachable
+        bool *clusterStale; // [cluster]
+        // Abstract search: one node per slot plus the start and target. parentX holds the parent's node id.
+        Node *nodes; // nodeCount + 2
+        OpenSet queue;
+        unsigned int generation;
+    } HierarchicalMap;
+
+    // ARA* bookkeeping on top of the shared SearchWorkspace: nodes whose cost dropped after they were
+    // closed wait here until the next, lower-weight pass puts them back in the open set
+    typedef struct {
+        bool *inconsistent; // One per cell
+        Node **inconsistentNodes; // Room for every cell
+        int inconsistentCount;
+        Node **closedNodes; // Closed this pass, so the next pass reopens only these. Room for every cell.
+        int closedCount;
+        float boundReached; // Proven suboptimality of the last path: its cost is at most this times optimal
+    } AnytimeSearch;
+
+    // Space-time A* state. The reservation table holds the chance that some mine sits on a cell
+    // after t robot moves, and the search runs over (x, y, t) so routes can dodge mines in time.
+    // The robot can't get further than the horizon, so the (x, y, t) arrays only cover the box of
+    // SPACETIME_BOX_SIDE cells a side centred on it, layer t first: [t * cellCount + BoxIndex].
+    typedef struct {
+        int boxX, boxY; // Window cell at the box's corner
+        int width, height, cellCount; // Of the box
+        float *reservation;
+        Node *nodes; // parent is always at t - 1
+        float *pathRisk; // Collision chance along the best route found to (x, y, t)
+        int *goalDistance; // Wall-aware steps to the target over the whole window, the heuristic past the horizon
+        int *frontier; // BFS queue for goalDistance
+        unsigned char *stateSlot; // [window CellIndex * 4 + direction]: 1 + index of a predicted mine state while merging, 0 if none
+        OpenSet queue;
+        unsigned int generation;
+    } SpaceTimePlanner;
+
+    typedef enum {
+        PLANNER_ASTAR,
+        PLANNER_DSTAR_LITE,
+        PLANNER_FLOW_FIELD,
+        PLANNER_JPS,
+        PLANNER_HPA,
+        PLANNER_SPACETIME,
+        PLANNER_ARA,
+        PLANNER_BIDIRECTIONAL,
+        PLANNER_COUNT
+    } PathPlanner;
+
+    // Everything a player does that the simulation sees. Live play and replays both go through
+    // ApplyGameInput, so a replay runs exactly the code the keys did.
+    typedef enum {
+        INPUT_DIRECTION,
+        INPUT_SPRINT,
+        INPUT_AI_MODE,
+        INPUT_HEURISTIC_WEIGHT,
+        INPUT_PLANNER,
+        INPUT_RESCUE_ORDER,
+        INPUT_SEARCH_BUDGET,
+        INPUT_PATH_CACHE,
+        INPUT_SKIP_LEVEL,
+        INPUT_PAINT,
+        INPUT_COUNT
+    } InputType;
+
+    typedef struct {
+        InputType type;
+        int value; // Direction, planner, 0/1 for switches, or the cell value painted
+        float weight; // INPUT_HEURISTIC_WEIGHT
+        GridPos from, to; // INPUT_PAINT, a single cell when they match
+    } GameInput;
+
+    // Replay records after the inputs, which keep their InputType values
+    typedef enum {
+        REPLAY_CHECKSUM = INPUT_COUNT, // State checksum after the record's tick
+        REPLAY_END, // Final tick and checksum
+        REPLAY_BUDGET_SPENT // A search time budget ran out during the record's tick, at the given budget check
+    } ReplayRecordType;
+
+    typedef struct {
+        const char *path; // --record, NULL when not recording
+        FILE *file; // Open from the start of the game to its end
+        int lastTick; // Records store their tick as the ticks since the one before
+        bool finished; // Only the first game played is recorded
+        uint64_t lastBudgetSpent; // Budget records store their check as the checks since the one before
+    } ReplayRecorder;
+
+    // The budget checks a replay is told ran out, queued before the tick they happen in
+    typedef struct {
+        bool active; // Replaying: time budgets run out at these checks and nowhere else
+        uint64_t spentAt[REPLAY_BUDGET_QUEUE]; // Values of budgetChecks, oldest first
+        int count;
+    } ReplayBudgets;
+
+    // The order MUST match the enum order above!
+    static const char* plannerNames[] = {
+        "A*",
+        "D* Lite",
+        "Flow Field",
+        "Jump Point Search",
+        "HPA*",
+        "Space-Time A*",
+        "Anytime A* (ARA*)",
+        "Bidirectional A*",
+    };
+
     typedef enum {
         CELL_AIR = 0,
         CELL_WALL,
@@ -69,24 +335,90 @@
     } Direction;
 
     // The order MUST match the enum order above!
-    static const Vector2 DIR_VECTORS[] = {
+    static const GridPos DIR_VECTORS[] = {
         { 0, -1 }, // Matches NORTH (0)
         { 1,  0 }, // Matches EAST (1)
         { 0,  1 }, // Matches SOUTH (2)
         {-1,  0 },  // Matches WEST (3)
     };
 
+    // People or mines, one array per field so a tick's rolls for the whole pool run down
+    // contiguous memory (see RollEntityPool). Coordinates fit in 16 bits as MAX_GRID_SIDE < 32768.
+    typedef struct {
+        int count;
+        int capacity;
+        int16_t *x, *y; // x is ENTITY_DISABLED once rescued or off the grid
+        int16_t *previousX, *previousY; // Before the last tick, drawing interpolates from here
+        uint8_t *direction; // Direction
+        uint16_t *moveChance; // Per tick, out of ENTITY_CHANCE_ONE
+        uint16_t *turnChance; // Per tick, out of ENTITY_CHANCE_ONE. Half the turns are clockwise, half none.
+        uint8_t *stepping; // Set by this tick's roll
+        GameRandom *rng; // One stream each, reseeded every level
+        unsigned char *block; // Everything above, carved from one allocation
+        EntityIndex at; // Cell to slot for every active entity, kept in step with the grid by PlaceEntity/RemoveEntity
+    } EntityPool;
+
+    static inline bool EntityIsActive(const EntityPool *pool, int i) {
+        return pool->x[i] != ENTITY_DISABLED;
+    }
+
+    static inline GridPos EntityPosition(const EntityPool *pool, int i) {
+        return (GridPos){pool->x[i], pool->y[i]};
+    }
+
+    // Visiting order for the live people, planned over wall-aware step distances. Only redone when
+    // walls change, someone is rescued out of turn, or a person drifts from where they were planned.
+    typedef struct {
+        int order[NUM_PEOPLE]; // Person indices, next to rescue first
+        int orderLen;
+        int tourLength; // Steps for the whole tour when planned
+        GridPos plannedAt[NUM_PEOPLE]; // Where each person stood when the tour was planned
+        bool stale;
+        int *distance; // BFS steps out from each person, one grid per live person
+        int *frontier;
+        int heldKarpCost[1 << RESCUE_HELD_KARP_PEOPLE][RESCUE_HELD_KARP_PEOPLE]; // Cheapest way to visit a set, ending at one of them
+        signed char heldKarpPrev[1 << RESCUE_HELD_KARP_PEOPLE][RESCUE_HELD_KARP_PEOPLE];
+    } RescuePlan;
+
+    // The part of the arena the AI plans in. Every planner, bitboard and per-cell array works in
+    // window coordinates, where window cell (x, y) is world cell (originX + x, originY + y). Arenas
+    // up to AI_WINDOW_SIDE a side fit whole, so there the two coincide and the window never moves.
+    typedef struct {
+        int originX, originY;
+        int width, height, cellCount;
+        bool placed; // False until the AI first plans
+        bool targetOutside; // The last goal was a waypoint on the way to a target beyond the window
+    } PlanningWindow;
+
+    // Long-range routing on arenas bigger than the window. Each world tile splits into the connected
+    // open regions of its cells, and an A* over (tile, region) nodes finds the tiles to cross. The
+    // window's planners then head for the furthest point of that route still inside the window.
+    typedef struct {
+        int tilesX, tilesY;
+        uint16_t **labels; // Per tile, 1 + region of each cell and 0 for walls. NULL for a tile without walls, all one region.
+        int *regionCount; // Per tile, -1 once a wall in it changes, until counted again
+        int *firstNode; // Per tile, node id of its region 0
+        bool stale; // Some tile needs recounting, and then every node id after it shifts
+        Node *nodes; // One per (tile, region). x, y: the tile. parentX: the parent's node id.
+        int nodeCount, nodeCapacity;
+        OpenSet queue;
+        unsigned int generation;
+        int *route; // Node ids from the robot's region to the target's, room for every node
+        int routeLength;
+    } TileRouter;
+
     typedef struct {
-        Vector2 position;
+        int x, y;
         Direction direction;
-        float liklihoodToMove;
-        float liklihoodToTurn;
-    } MovingEntity;
+        float probability;
+    } MineState; // One possible future of a mine, for the space-time planner
 
     typedef struct {
-        Vector2 position;
+        GridPos position;
         Direction direction;
-        int moveCooldown; // number of frames between robot moves
+        GridPos previousPosition; // Before the last tick, drawing interpolates from here
+        int moveCooldown; // number of ticks between robot moves
+        GameRandom rng; // For the AI's tie-breaks
     } Robot;
 
     // The Context struct holds all game data so we can pass it around easily
@@ -99,8 +431,16 @@
         char username[20];
         int usernameLen;
         int currentLevel;
+        unsigned int seed; // Mixed into every level's seed (--seed), 0 plays the default levels
+        GameRandom rng; // Level layout, entities draw from their own streams
         int livesRemaining;
-        int frameCount; // Total frames unpaused in levels. This is used for scoring.
+        int tickCount; // Total ticks simulated in levels
+        double playTime; // Simulated seconds in levels. This is used for scoring.
+
+        // Fixed Timestep
+        int baseTickRate; // Ticks per second at level 1 (--tick-rate)
+        int tickRate; // Rises with the level once the robot's cooldown bottoms out
+        double tickAccumulator; // Frame time not yet simulated, seconds
 
         // Camera & View
         Camera3D camera;
@@ -108,37 +448,157 @@
 
 
         // The World
-        int grid[GRID_WIDTH][GRID_HEIGHT];
+        int gridWidth, gridHeight; // Fixed at startup (--grid), every per-cell array is row-major
+        int cellCount;
+        World world; // Tiles only where there is content. Read with GetGridCell, written with SetGridCell
+        void *cellStorage; // The one allocation every per-window-cell array is carved from, NULL until the AI plans
+        size_t cellStorageBytes;
 
         // Entities: Robot
         Robot robot;
 
         // Entities: People
-        MovingEntity people[NUM_PEOPLE];
+        EntityPool people; // NUM_PEOPLE of them
         int peopleRemaining;
         float peopleMaxMovesPerSec;
 
         // Entities: Mines
-        MovingEntity* mines; // Dynamic array
-        int mineCount;
+        EntityPool mines; // Regrown by AdvanceLevel
         float minesMaxMovesPerSec;
 
-        // AI & Pathfinding
+        // AI & Pathfinding. Nothing below is allocated until the AI first plans (see PrepareAiWindow).
         bool aiModeEnabled;
         float AStarHeuristicWeightage;
-        Vector2 currentPath[MAX_PATH_LENGTH];
+        PlanningWindow window;
+        TileRouter router;
+        GridPos *currentPath; // Room for a path through every cell of the window
         int currentPathLen;
+        int searchNodesExpanded; // Nodes popped from the open set by the last search
+        SearchWorkspace searchWorkspace;
+        SearchWorkspace reverseWorkspace; // Target-side half of the bidirectional search
+        GridBitboards bitboards; // Kept in step with every grid write by SetGridCell and MarkAllCellsDirty
+        PathPlanner planner;
+        DirtyCells dirtyCells;
+        bool pathCacheEnabled;
+        PathCache pathCache;
+        DStarLite dstar;
+        JumpPointTables jps;
+        HierarchicalMap hpa;
+        SpaceTimePlanner spaceTime;
+        AnytimeSearch ara;
+        bool plannedRescueOrder; // Follow the rescue tour instead of the nearest person
+        bool searchBudgetEnabled; // Spread A* over the frames between moves instead of finishing it in one
+        int searchNodeBudget; // Expansions per frame, 0 for no limit
+        int searchTimeBudgetUs; // Microseconds per frame, 0 for no limit
+        uint64_t budgetChecks; // Time budget checks made this game, see SearchBudgetSpent
+        ReplayBudgets replayBudgets;
+        float updateTimes[FRAME_TIME_SAMPLES]; // Ring buffer of gameplay update times, ms
+        int updateTimeCount;
+        int updateTimeNext;
+        RescuePlan rescuePlan;
+
+        GameOverScreen gameOver;
 
         // Input & Interaction
-        Vector2 gridCellFocused;
-        Vector2 lastGridCellFocused;
+        GridPos gridCellFocused;
+        GridPos lastGridCellFocused;
+        bool sprintHeld; // Sampled once a frame, the simulation never reads the keyboard itself
+        bool spaceHeld; // A level reached while space is held starts unpaused
+        ReplayRecorder recorder;
 
     } GameContext;
 
+    // What happened on one level of a headless game
+    typedef struct {
+        int level;
+        bool cleared;
+        bool outOfLives;
+        int ticks;
+        double simSeconds;
+        int livesLost;
+        int people, rescued;
+        int mines;
+        int cacheHits, cacheMisses;
+    } LevelStats;
+
+    // A worker's share of a batch: game indices [begin, end) packed as begin | end << 32, alone on
+    // its cache line so workers taking games never invalidate each other's
+    typedef struct {
+        uint64_t range;
+        char padding[64 - sizeof(uint64_t)];
+    } BatchQueue;
+
+    typedef struct {
+        // Settings every game starts from
+        int gridWidth, gridHeight;
+        int tickRate;
+        PathPlanner planner;
+        unsigned int baseSeed; // Game i plays seed baseSeed + i
+        int levels;
+        int threadCount;
+        BatchQueue *queues; // One per thread
+        // Results, written with atomic adds so no worker ever waits on another
+        int *clearedPerGame;
+        long long gamesDone, levelsCleared, ticks, livesLost, timeouts, steals;
+    } BatchRun;
+
+    typedef struct {
+        BatchRun *run;
+        int index;
+    } BatchWorker;
+
+    static inline bool IsInsideGrid(const GameContext *ctx, int x, int y) {
+        return x >= 0 && x < ctx->gridWidth && y >= 0 && y < ctx->gridHeight;
+    }
+
+    static inline bool IsInsideWindow(const GameContext *ctx, int x, int y) {
+        return x >= 0 && x < ctx->window.width && y >= 0 && y < ctx->window.height;
+    }
+
+    // World cell to window cell, which may fall outside the window
+    static inline GridPos WorldToWindow(const GameContext *ctx, GridPos pos) {
+        return (GridPos){pos.x - ctx->window.originX, pos.y - ctx->window.originY};
+    }
+
+    static inline GridPos WindowToWorld(const GameContext *ctx, GridPos pos) {
+        return (GridPos){pos.x + ctx->window.originX, pos.y + ctx->window.originY};
+    }
+
+    static inline int GetGridCell(const GameContext *ctx, int x, int y) {
+        return WorldGet(&ctx->world, x, y);
+    }
+
+    // The planners' inner loops ask the bitboards instead, which skips the tile directory
+    static inline bool IsWallCell(const GameContext *ctx, int x, int y) {
+        return BitboardTest(&ctx->bitboards.wall, x, y);
+    }
+
+    static inline bool IsMineCell(const GameContext *ctx, int x, int y) {
+        return BitboardTest(&ctx->bitboards.mine, x, y);
+    }
+
+    // Where the robot starts each level and respawns after a hit
+    static inline GridPos GetRobotSpawn(const GameContext *ctx) {
+        return (GridPos){3*ctx->gridWidth/4, ctx->gridHeight/4};
+    }
+
+    // The robot may never step back onto its respawn point (see MoveEntity), so to the planners it is
+    // a wall. (x, y) is a window cell, like everything the planners ask about.
+    static inline bool IsRobotSpawn(const GameContext *ctx, int x, int y) {
+        GridPos spawn = WorldToWindow(ctx, GetRobotSpawn(ctx));
+        return x == spawn.x && y == spawn.y;
+    }
+
 //--------------------------------------------------------------------------------------
 // Function Forward Declarations
 //--------------------------------------------------------------------------------------
-    void InitGame(GameContext *ctx);
+    void InitGame(GameContext *ctx, int gridWidth, int gridHeight, unsigned int seed);
+    void FreeGame(GameContext *ctx);
+    void AllocateCellStorage(GameContext *ctx);
+    void ReserveEntityPool(EntityPool *pool, int capacity);
+    void FreeEntityPool(EntityPool *pool);
+    void PlaceEntity(GameContext *ctx, EntityPool *pool, int i, int x, int y);
+    void RemoveEntity(GameContext *ctx, EntityPool *pool, int i);
     void AdvanceLevel(GameContext *ctx); // Clears grid for new level
 
     // The three "Screen" functions
@@ -146,31 +606,176 @@
     void UpdateDrawGameplay(GameContext *ctx);
     void UpdateDrawGameOver(GameContext *ctx);
 
+    // Simulation, shared by the window and --headless
+    void StepGameplay(GameContext *ctx);
+    void MoveEntity(GameContext *ctx, CellType entityCellType, int *x, int *y, Direction dir);
+    void RollEntityPool(EntityPool *pool);
+    void MoveEntityPool(GameContext *ctx, EntityPool *pool, CellType entityCellType);
+    GridPos pick_robot_target(GameContext *ctx);
+    void move_robot_ai(GameContext *ctx);
+    void BeginHeadlessGame(GameContext *ctx);
+    bool PlayHeadlessLevel(GameContext *ctx, LevelStats *stats);
+    int RunHeadless(GameContext *ctx, int levels);
+    int RunBatch(const GameContext *settings, int levels, int games, int threadCount);
+    bool ApplyGameInput(GameContext *ctx, GameInput input);
+    void SubmitGameInput(GameContext *ctx, GameInput input);
+    uint64_t GetStateChecksum(GameContext *ctx);
+    void BeginReplayRecording(GameContext *ctx);
+    void WriteReplayChecksum(GameContext *ctx);
+    void WriteReplayBudgetSpent(GameContext *ctx);
+    void FinishReplayRecording(GameContext *ctx);
+    int RunReplay(const char *path);
+
     // helpers
     void DrawSingleBattery(Vector3 pos, float rotationY, bool isActive);
     void DrawBatteries(GameContext *ctx);
-    void PaintGridLine(GameContext *ctx, int x0, int y0, int x1, int y1, int value);
+    bool PaintGridLine(GameContext *ctx, int x0, int y0, int x1, int y1, int value);
+    void SetGridCell(GameContext *ctx, int x, int y, int value);
+    void PutWorldCell(GameContext *ctx, int x, int y, int value);
+    void MarkAllCellsDirty(GameContext *ctx);
+    bool InitGridBitboards(GridBitboards *boards, int width, int height);
+    void FreeGridBitboards(GridBitboards *boards);
+    void RefreshMineDanger(GameContext *ctx);
+    bool IsNearMine(GameContext *ctx, int x, int y);
+    int GetMineSafetyScore(GameContext *ctx, int x, int y);
+    int GetBlockedNeighbours(GameContext *ctx, int x, int y);
+    bool CheckPathCache(GameContext *ctx, int previousPathLen, int startX, int startY, int targetX, int targetY);
     void UpdateCustomCamera(Camera3D *camera, bool *orbitMode);
     void HandleGridInteraction(GameContext *ctx);
     void DrawGameScene(GameContext *ctx);
     int CompareScores(const void *a, const void *b);
+    void RecordUpdateTime(GameContext *ctx, float milliseconds);
+    float GetUpdateTimePercentile(GameContext *ctx, float percentile);
+
+    // A* open set
+    bool InitOpenSet(OpenSet *set, int capacity);
+    void OpenSetPush(OpenSet *set, Node *node);
+    Node* OpenSetPop(OpenSet *set);
+    void OpenSetDecreaseKey(OpenSet *set, Node *node);
+    void OpenSetUpdate(OpenSet *set, Node *node);
+    void OpenSetRemove(OpenSet *set, Node *node);
+    void BeginSearch(SearchWorkspace *ws);
+    Node* GetSearchNode(SearchWorkspace *ws, int x, int y);
+    int GetEnterCost(GameContext *ctx, int x, int y);
+    void BuildStepDistance(GameContext *ctx, int *distance, int *frontier, int sourceX, int sourceY);
+
+    // Path planners
+    void PlanPathAStar(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void BeginAStar(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    bool ContinueAStar(GameContext *ctx, int nodeBudget, double timeBudget);
+    void TraceAStarPath(GameContext *ctx, int fromX, int fromY);
+    void AdvanceBudgetedAStar(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void PlanPathDStarLite(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void PlanPathFlowField(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void PlanPathJPS(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void PlanPathHPA(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void PlanPathSpaceTime(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void PlanPathARA(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+    void PlanPathBidirectional(GameContext *ctx, int startX, int startY, int targetX, int targetY);
+
+    // Planning window and tile routes
+    void AllocateAiState(GameContext *ctx);
+    size_t AiMemoryUsed(const GameContext *ctx);
+    void PrepareAiWindow(GameContext *ctx);
+    void LoadAiWindow(GameContext *ctx);
+    GridPos GetWindowGoal(GameContext *ctx, GridPos target);
+    bool InitTileRouter(TileRouter *router, int tilesX, int tilesY);
+    void FreeTileRouter(TileRouter *router);
+    size_t TileRouterMemoryUsed(const TileRouter *router);
+    void MarkAllTilesStale(TileRouter *router);
+    void MarkTileStale(TileRouter *router, int x, int y);
+
+    // Rescue ordering
+    void PlanRescueTour(GameContext *ctx);
+    int NextRescueTarget(GameContext *ctx);
+    void MarkClustersStale(GameContext *ctx, int x, int y);
 
     int min(int a, int b);
     int max(int a, int b);
+    int GetDistance(int x1, int y1, int x2, int y2);
     Direction GetCameraForwardDirection(Camera3D camera);
+    double GetMonotonicTime(void);
+    bool SearchBudgetSpent(GameContext *ctx, double start, double budget);
+    void SeedGameRandom(GameRandom *rng, uint64_t seed, uint64_t stream);
+    void SeedLevelRandom(GameContext *ctx, GameRandom *rng, uint64_t stream);
+    uint32_t NextGameRandom(GameRandom *rng);
+    uint32_t NextGameRandomBelow(GameRandom *rng, uint32_t bound);
+    float NextGameRandomFloat(GameRandom *rng);
 
 //--------------------------------------------------------------------------------------
 // Main Entry Point
 //--------------------------------------------------------------------------------------
-    int main(void) {
-        SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
-        InitWindow(800, 450, "Robot Save the People - State Machine, A* Algo");
+    int main(int argc, char **argv) {
+        // Arena size, e.g. "./game --grid 200x120" for stress tests
+        int gridWidth = DEFAULT_GRID_WIDTH;
+        int gridHeight = DEFAULT_GRID_HEIGHT;
+        int tickRate = DEFAULT_TICK_RATE;
+        // "./game --headless --levels 50 --seed 7" plays with the AI and no window, for CI
+        bool headless = false;
+        int levels = DEFAULT_HEADLESS_LEVELS;
+        unsigned int seed = 0;
+        // "./game --headless --batch 1000" plays seeds 0..999 at once, one game per core
+        int batchGames = 0;
+        int threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (threadCount < 1) threadCount = 1;
+        // "./game --record run.rpl" saves the first game's inputs, "./game --replay run.rpl" plays them back
+        const char *recordPath = NULL;
+        const char *replayPath = NULL;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc
+                && sscanf(argv[++i], "%dx%d", &gridWidth, &gridHeight) == 2
+                && gridWidth >= MIN_GRID_SIDE && gridWidth <= MAX_GRID_SIDE
+                && gridHeight >= MIN_GRID_SIDE && gridHeight <= MAX_GRID_SIDE) continue;
+            if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc
+                && sscanf(argv[++i], "%d", &tickRate) == 1 && tickRate >= 1 && tickRate <= MAX_TICK_RATE) continue;
+            if (strcmp(argv[i], "--headless") == 0) { headless = true; continue; }
+            if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc
+                && sscanf(argv[++i], "%d", &levels) == 1 && levels >= 1) continue;
+            if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc
+                && sscanf(argv[++i], "%u", &seed) == 1) continue;
+            if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc
+                && sscanf(argv[++i], "%d", &batchGames) == 1 && batchGames >= 1) continue;
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc
+                && sscanf(argv[++i], "%d", &threadCount) == 1 && threadCount >= 1) continue;
+            if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) { recordPath = argv[++i]; continue; }
+            if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) { replayPath = argv[++i]; continue; }
+            printf("Usage: %s [--grid WIDTHxHEIGHT] [--tick-rate N] [--seed S] [--record FILE] [--headless [--levels N] [--batch GAMES [--threads N]]]\n", argv[0]);
+            printf("       %s --replay FILE\n", argv[0]);
+            printf("  --grid       each side %d to %d, default %dx%d\n", MIN_GRID_SIDE, MAX_GRID_SIDE, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+            printf("  --tick-rate  simulation ticks per second at level 1, 1 to %d, default %d\n", MAX_TICK_RATE, DEFAULT_TICK_RATE);
+            printf("  --seed       varies every level's layout, default 0 (the default levels)\n");
+            printf("  --headless   let the AI play without a window, printing stats per level\n");
+            printf("  --levels     levels the headless run plays, default %d\n", DEFAULT_HEADLESS_LEVELS);
+            printf("  --batch      play this many games, seeds S upwards, printing only the totals\n");
+            printf("  --threads    threads the batch runs on, default one per core\n");
+            printf("  --record     save the first game's inputs and checksums to FILE, not for batches\n");
+            printf("  --replay     re-simulate a recorded game with no window and check it plays out the same\n");
+            return EXIT_FAILURE;
+        }
+        if (recordPath != NULL && batchGames > 0) {
+            printf("--record saves a single game, it can't be used with --batch.\n");
+            return EXIT_FAILURE;
+        }
+        if (replayPath != NULL) return RunReplay(replayPath);
 
         // Initialise the Game Context (Camera, vars, etc)
         GameContext ctx = { 0 };
-        InitGame(&ctx);
+        InitGame(&ctx, gridWidth, gridHeight, seed);
+        ctx.baseTickRate = tickRate;
+        ctx.tickRate = tickRate;
+        ctx.recorder.path = recordPath;
+
+        if (headless) {
+            int status = (batchGames > 0) ? RunBatch(&ctx, levels, batchGames, threadCount) : RunHeadless(&ctx, levels);
+            FreeGame(&ctx);
+            return status;
+        }
+
+        SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
+        InitWindow(800, 450, "Robot Save the People - State Machine, A* Algo");
 
-        SetTargetFPS(60);
+        // Only drawing is tied to this, the simulation keeps its own clock
+        SetTargetFPS(RENDER_FPS);
 
         while (!WindowShouldClose() && !IsKeyPressed(KEY_Q))
         {
@@ -190,6 +795,8 @@
         }
 
         CloseWindow();
+        FinishReplayRecording(&ctx); // Quit mid-game
+        FreeGame(&ctx);
         return 0;
     }
 
@@ -230,6 +837,7 @@
             ctx->currentLevel = 0;
             AdvanceLevel(ctx); 
             ctx->currentState = STATE_PLAYING;
+            BeginReplayRecording(ctx);
         }
 
         // 3. DRAWING
@@ -271,297 +879,37 @@
     }
 
     void UpdateDrawGameplay(GameContext *ctx) {
-        void MoveEntity(GameContext *ctx, MovingEntity *entity, CellType entityCellType, Vector2 *pos, Direction *dir) {
-            Vector2* dirVec = &DIR_VECTORS[*dir];
-            Vector2 futurePos = Vector2Add(*pos, *dirVec); 
-            // check its not outside the grid
-            if (   futurePos.x >= GRID_WIDTH  || futurePos.x < 0
-                || futurePos.y >= GRID_HEIGHT || futurePos.y < 0) return;
-            
-            // Robots can't occupy the robot respawn point
-            if (entityCellType == CELL_ROBOT 
-                && futurePos.x == 3*GRID_HEIGHT/4 
-                && futurePos.y == GRID_WIDTH/4) {
-                    return;
-            }
-
-            CellType futureCell = ctx->grid[(int)futurePos.x][(int)futurePos.y];
-            // if robot collides with person
-            if (futureCell == CELL_PERSON && entityCellType == CELL_ROBOT) {
-                ctx->peopleRemaining += -1;
-                // disable the person
-                // do so by first finding them, then setting their coords to invalid values
-                for (int i=0; i<NUM_PEOPLE; i++) {
-                    if (ctx->people[i].position.x == futurePos.x && ctx->people[i].position.y == futurePos.y) {
-                        ctx->people[i].position = (Vector2){-1, -1};
-                        break;
-                    }
-                }
-                // dont return, which causes the robot to move onwards
-            }
-            // if person collides with robot
-            if (futureCell == CELL_ROBOT && entityCellType == CELL_PERSON) {
-                ctx->peopleRemaining += -1;
-                // disable the person
-                // do so by setting their coords to invalid values
-                entity->position = (Vector2){-1, -1};
-                return;
-            }
-
-            if (((futureCell == CELL_WALL || futureCell == CELL_MINE) && entityCellType == CELL_ROBOT)
-                || (futureCell == CELL_ROBOT && entityCellType == CELL_MINE) ) {
-                    ctx->livesRemaining += -1;
-                    // reset pos
-                    ctx->grid[(int)pos->x][(int)pos->y] = CELL_AIR;
-                    ctx->robot.position = (Vector2){3*GRID_HEIGHT/4, GRID_WIDTH/4};
-                if (entityCellType == CELL_ROBOT) return;
-            }
-
-            if (futureCell == CELL_WALL || futureCell == CELL_MINE) return;
-
-            ctx->grid[(int)pos->x][(int)pos->y] = CELL_AIR;
-            *pos = futurePos;
-            ctx->grid[(int)futurePos.x][(int)futurePos.y] = entityCellType;
-        }
-
-        void MoveMovingEntity(GameContext *ctx, MovingEntity *entity, CellType entityCellType) {
-            // if the position is invalid, the entity is disabled and shouldn't be moved
-            if (entity->position.x == -1) return;
-            if (rand() < entity->liklihoodToTurn * RAND_MAX) {
-                entity->direction = (entity->direction + rand() % 2) % 4;
-            }
-            if (rand() < entity->liklihoodToMove * RAND_MAX) {
-                MoveEntity(ctx, entity, entityCellType, &entity->position, &entity->direction);
-            }
-        }
-
-        void move_robot_ai(GameContext *ctx) {
-            // Simple Manhattan Distance Heuristic
-            int GetDistance(int x1, int y1, int x2, int y2) {
-                return abs(x1 - x2) + abs(y1 - y2);
-            }
-
-            bool IsNearMine(GameContext *ctx, int x, int y) {
-                // Check all 8 surrounding neighbors (diagonals included)
-                for (int dx = -1; dx <= 1; dx++) {
-                    for (int dy = -1; dy <= 1; dy++) {
-                        if (dx == 0 && dy == 0) continue; // Skip the center tile itself
-                        
-                        int nx = x + dx;
-                        int ny = y + dy;
-                        
-                        // Bounds check
-                        if (nx >= 0 && nx < GRID_WIDTH && ny >= 0 && ny < GRID_HEIGHT) {
-                            if (ctx->grid[nx][ny] == CELL_MINE) return true;
-                        }
-                    }
-                }
-                return false;
-            }
-
-            // Scans a radius around (x,y) to find the distance to the closest mine.
-            // Returns a high number if safe, low number if dangerous.
-            int GetLocalSafetyScore(GameContext *ctx, int x, int y, int radius) {
-                int closestMineDist = 999;
-                
-                for (int dx = -radius; dx <= radius; dx++) {
-                    for (int dy = -radius; dy <= radius; dy++) {
-                        int nx = x + dx;
-                        int ny = y + dy;
-                        
-                        if (nx >= 0 && nx < GRID_WIDTH && ny >= 0 && ny < GRID_HEIGHT) {
-                            if (ctx->grid[nx][ny] == CELL_MINE) {
-                                int dist = abs(dx) + abs(dy); // Manhattan distance to the hazard
-                                if (dist < closestMineDist) closestMineDist = dist;
-                            }
-                        }
-                    }
-                }
-                return closestMineDist;
-            }
-
-            // 1. CLEAR PREVIOUS PATH
-            ctx->currentPathLen = 0;
-
-            // 2. FIND TARGET
-            Vector2 startPos = ctx->robot.position;
-            Vector2 targetPos = {-1, -1};
-            int shortestDist = 99999;
-
-            for (int i = 0; i < 5; i++) {
-                if (ctx->people[i].position.x != -1) {
-                    int dist = GetDistance((int)startPos.x, (int)startPos.y, 
-                                        (int)ctx->people[i].position.x, (int)ctx->people[i].position.y);
-                    if (dist < shortestDist) {
-                        shortestDist = dist;
-                        targetPos = ctx->people[i].position;
-                    }
-                }
-            }
-
-            // If no target, we skip A* and go straight to fallback
-            if (targetPos.x != -1) {
-
-                // 3. INITIALIZE A* DATA
-                static Node nodes[GRID_WIDTH][GRID_HEIGHT]; 
-                for (int x = 0; x < GRID_WIDTH; x++) {
-                    for (int y = 0; y < GRID_HEIGHT; y++) {
-                        nodes[x][y] = (Node){x, y, 9999, 9999, 9999, -1, -1, false, false};
-                    }
-                }
-
-                int startX = (int)startPos.x;
-                int startY = (int)startPos.y;
-                int targetX = (int)targetPos.x;
-                int targetY = (int)targetPos.y;
-
-                nodes[startX][startY].gCost = 0;
-                nodes[startX][startY].hCost = GetDistance(startX, startY, targetX, targetY);
-                nodes[startX][startY].fCost = nodes[startX][startY].hCost;
-                nodes[startX][startY].open = true;
-
-                // 4. MAIN A* LOOP
-                while (true) {
-                    Node* current = NULL;
-                    int lowestF = 999999;
-
-                    for (int x = 0; x < GRID_WIDTH; x++) {
-                        for (int y = 0; y < GRID_HEIGHT; y++) {
-                            if (nodes[x][y].open && nodes[x][y].fCost < lowestF) {
-                                current = &nodes[x][y];
-                                lowestF = nodes[x][y].fCost;
-                            }
-                        }
-                    }
-
-                    // FIX 1: If no path found, BREAK (don't return) so we can run the fallback logic
-                    if (current == NULL) break; 
-
-                    if (current->x == targetX && current->y == targetY) {
-                        // Retrace path
-                        int traceX = targetX;
-                        int traceY = targetY;
-                        while (traceX != -1 && traceY != -1) {
-                            if (traceX == startX && traceY == startY) break;
-                            ctx->currentPath[ctx->currentPathLen] = (Vector2){(float)traceX, (float)traceY};
-                            ctx->currentPathLen++;
-                            int pX = nodes[traceX][traceY].parentX;
-                            int pY = nodes[traceX][traceY].parentY;
-                            traceX = pX;
-                            traceY = pY;
-                        }
-                        break;
-                    }
-
-                    current->open = false;
-                    current->closed = true;
-
-                    int dirX[] = {0, 1, 0, -1};
-                    int dirY[] = {-1, 0, 1, 0};
-
-                    for (int i = 0; i < 4; i++) {
-                        int checkX = current->x + dirX[i];
-                        int checkY = current->y + dirY[i];
-
-                        if (checkX < 0 || checkX >= GRID_WIDTH || checkY < 0 || checkY >= GRID_HEIGHT) continue;
-                        
-                        int cell = ctx->grid[checkX][checkY];
-                        if (cell == CELL_WALL || cell == CELL_MINE) continue;
-                        if (nodes[checkX][checkY].closed) continue;
-
-                        // FIX 2: Soft Penalty instead of Hard Wall
-                        // If tile is near a mine, add 20 to the cost (robot will detour if possible)
-                        // But it WILL go there if it's the only path.
-                        int dangerPenalty = 0;
-                        if (IsNearMine(ctx, checkX, checkY)) dangerPenalty = 20;
-
-                        int moveCost = nodes[current->x][current->y].gCost + 1 + dangerPenalty;
-
-                        if (moveCost < nodes[checkX][checkY].gCost || !nodes[checkX][checkY].open) {
-                            nodes[checkX][checkY].gCost = moveCost;
-                            // Ensure you have this multiplier variable in your struct, or use 1.5f directly
-                            nodes[checkX][checkY].hCost = (int)(GetDistance(checkX, checkY, targetX, targetY) * ctx->AStarHeuristicWeightage); 
-                            nodes[checkX][checkY].fCost = nodes[checkX][checkY].gCost + nodes[checkX][checkY].hCost;
-                            nodes[checkX][checkY].parentX = current->x;
-                            nodes[checkX][checkY].parentY = current->y;
-                            nodes[checkX][checkY].open = true;
-                        }
-                    }
-                }
-            }
-
-            // 5. EXECUTE MOVE (Or Fallback)
-            if (ctx->currentPathLen > 0) {
-                Vector2 nextStep = ctx->currentPath[ctx->currentPathLen - 1];
-                
-                int dx = (int)nextStep.x - (int)startPos.x;
-                int dy = (int)nextStep.y - (int)startPos.y;
-
-                if (dy == -1) ctx->robot.direction = NORTH;
-                if (dx == 1)  ctx->robot.direction = EAST;
-                if (dy == 1)  ctx->robot.direction = SOUTH;
-                if (dx == -1) ctx->robot.direction = WEST;
-            }
-            else {
-                // FALLBACK: Run the Survival Logic
-                // (This code remains exactly as we wrote it in the previous step)
-                int bestScore = -1;
-                Vector2 bestMove = {-1, -1};
-                Direction bestDir = ctx->robot.direction; 
-                
-                int dx[] = {0, 1, 0, -1};
-                int dy[] = {-1, 0, 1, 0};
-                Direction dirs[] = {NORTH, EAST, SOUTH, WEST};
-                int startIdx = rand() % 4;
-
-                for (int i = 0; i < 4; i++) {
-                    int idx = (startIdx + i) % 4;
-                    int nx = (int)startPos.x + dx[idx];
-                    int ny = (int)startPos.y + dy[idx];
-
-                    if (nx < 0 || nx >= GRID_WIDTH || ny < 0 || ny >= GRID_HEIGHT) continue;
-                    if (ctx->grid[nx][ny] == CELL_WALL || ctx->grid[nx][ny] == CELL_MINE) continue;
-
-                    int score = GetLocalSafetyScore(ctx, nx, ny, 4);
-                    if (score > bestScore) {
-                        bestScore = score;
-                        bestMove = (Vector2){(float)nx, (float)ny};
-                        bestDir = dirs[idx];
-                    }
-                }
-                
-                if (bestMove.x != -1) {
-                    ctx->robot.direction = bestDir;
-                    ctx->currentPath[0] = bestMove;
-                    ctx->currentPathLen = 1;
-                } else {
-                    ctx->robot.direction = (Direction)((ctx->robot.direction + 2) % 4);
-                }
-            }
-        }
-                        
         void TurnRobotWithUserInputs(GameContext *ctx) {
             Direction camForward = GetCameraForwardDirection(ctx->camera);
             int baseDir = (int)camForward;
+            Direction dir = ctx->robot.direction;
 
-            if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) ctx->robot.direction = (Direction)((baseDir + 0) % 4);
-            if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) ctx->robot.direction = (Direction)((baseDir + 1) % 4);
-            if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) ctx->robot.direction = (Direction)((baseDir + 2) % 4);
-            if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) ctx->robot.direction = (Direction)((baseDir + 3) % 4);
+            if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) dir = (Direction)((baseDir + 0) % 4);
+            if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) dir = (Direction)((baseDir + 1) % 4);
+            if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) dir = (Direction)((baseDir + 2) % 4);
+            if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) dir = (Direction)((baseDir + 3) % 4);
+            if (dir != ctx->robot.direction) SubmitGameInput(ctx, (GameInput){.type = INPUT_DIRECTION, .value = dir});
         }
-
         
         // Update
+        // Anything the simulation sees goes through SubmitGameInput, so --record can save it
+        bool sprint = IsKeyDown(KEY_LEFT_SHIFT);
+        if (sprint != ctx->sprintHeld) SubmitGameInput(ctx, (GameInput){.type = INPUT_SPRINT, .value = sprint});
+        ctx->spaceHeld = IsKeyDown(KEY_SPACE);
         if (IsKeyPressed(KEY_O)) ctx->orbitMode = !ctx->orbitMode;    
 
         // Pause and unpause logic
         if (IsKeyPressed(KEY_SPACE)) ctx->paused = !ctx->paused;
 
         // Change player mode logic
-        if (IsKeyPressed(KEY_M)) ctx->aiModeEnabled = !ctx->aiModeEnabled;
+        if (IsKeyPressed(KEY_M)) SubmitGameInput(ctx, (GameInput){.type = INPUT_AI_MODE, .value = !ctx->aiModeEnabled});
 
-        if (IsKeyPressed(KEY_PERIOD)) ctx->AStarHeuristicWeightage += 0.05f;
-        if (IsKeyPressed(KEY_COMMA)) ctx->AStarHeuristicWeightage -= 0.05f;
+        if (IsKeyPressed(KEY_PERIOD)) SubmitGameInput(ctx, (GameInput){.type = INPUT_HEURISTIC_WEIGHT, .weight = ctx->AStarHeuristicWeightage + 0.05f});
+        if (IsKeyPressed(KEY_COMMA)) SubmitGameInput(ctx, (GameInput){.type = INPUT_HEURISTIC_WEIGHT, .weight = ctx->AStarHeuristicWeightage - 0.05f});
+        if (IsKeyPressed(KEY_P)) SubmitGameInput(ctx, (GameInput){.type = INPUT_PLANNER, .value = (ctx->planner + 1) % PLANNER_COUNT});
+        if (IsKeyPressed(KEY_R)) SubmitGameInput(ctx, (GameInput){.type = INPUT_RESCUE_ORDER, .value = !ctx->plannedRescueOrder});
+        if (IsKeyPressed(KEY_B)) SubmitGameInput(ctx, (GameInput){.type = INPUT_SEARCH_BUDGET, .value = !ctx->searchBudgetEnabled});
+        if (IsKeyPressed(KEY_C)) SubmitGameInput(ctx, (GameInput){.type = INPUT_PATH_CACHE, .value = !ctx->pathCacheEnabled});
 
         // For debugging
         //     if(IsKeyPressed(KEY_L)) ctx->livesRemaining += 1;
@@ -570,7 +918,7 @@
             // if(IsKeyPressed(KEY_L)) ctx->peopleRemaining += 1;
             // if(IsKeyPressed(KEY_K)) ctx->peopleRemaining += -1;
             // printf("People remaining: %d\n", ctx->peopleRemaining);
-            if(IsKeyPressed(KEY_U)) AdvanceLevel(ctx);
+            if(IsKeyPressed(KEY_U)) SubmitGameInput(ctx, (GameInput){.type = INPUT_SKIP_LEVEL});
 
 
 
@@ -578,36 +926,23 @@
         HandleGridInteraction(ctx);
 
         if (!ctx->paused) { // Gameplay: Inputs, entity movement, etc 
-            ctx->frameCount++;
-            // Move entities
-                // People
-                for (int i=0; i<NUM_PEOPLE; i++) {
-                    MoveMovingEntity(ctx, &ctx->people[i], CELL_PERSON);
-                }
-                // Mines
-                for (int i=0; i<ctx->mineCount; i++) {
-                    MoveMovingEntity(ctx, &ctx->mines[i], CELL_MINE);
-                }
-            
-            // Move robot
             // if user, take input every frame, but move robot after every cooldown
-            // if ai, then run A* before every move, so both things have the cooldown
             if (!ctx->aiModeEnabled) TurnRobotWithUserInputs(ctx);
 
-            int effectiveCooldown = ctx->robot.moveCooldown / (1 + IsKeyDown(KEY_LEFT_SHIFT));
-            if (effectiveCooldown < 1) effectiveCooldown = 1;
-            if (ctx->frameCount % effectiveCooldown == 0) {
-                if (ctx->aiModeEnabled) move_robot_ai(ctx);
-                // Move robot
-                // ctx->robot.position;
-                MoveEntity(ctx, (MovingEntity*)&ctx->robot, CELL_ROBOT, &ctx->robot.position, &ctx->robot.direction);
+            // Fixed timestep: run as many whole ticks as the frame time covers and carry the
+            // remainder, so the game keeps its speed whatever the frame rate
+            ctx->tickAccumulator += GetFrameTime();
+            int ticks = 0;
+            while (!ctx->paused && ctx->currentState == STATE_PLAYING && ctx->tickAccumulator >= 1.0 / ctx->tickRate) {
+                if (ticks++ == MAX_TICKS_PER_FRAME) {
+                    ctx->tickAccumulator = 0.0;
+                    break;
+                }
+                ctx->tickAccumulator -= 1.0 / ctx->tickRate;
+                StepGameplay(ctx);
             }
-
-            // check level advancement condition
-            if (ctx->peopleRemaining <= 0) AdvanceLevel(ctx);
-            // check death condition
-            if (ctx->livesRemaining <= 0) ctx->currentState = STATE_GAME_OVER;
         }
+        if (ctx->paused) ctx->tickAccumulator = 0.0; // Nothing to catch up on after unpausing
 
         // Draw
         BeginDrawing();
@@ -620,14 +955,12 @@
     }
 
     void UpdateDrawGameOver(GameContext *ctx) {
-        static bool isDataProcessed = false;
-        static ScoreEntry topScores[MAX_LEADERBOARD_ENTRIES];
-        static int totalScoresLoaded = 0;
-        static int currentRunDuration = 0;
+        GameOverScreen *screen = &ctx->gameOver;
 
         // 1. ONE-TIME LOGIC (Save & Load)
-        if (!isDataProcessed) {
-            currentRunDuration = ctx->frameCount / 60;
+        if (!screen->processed) {
+            screen->currentRunDuration = (int)ctx->playTime;
+            FinishReplayRecording(ctx);
 
             // A. APPEND CURRENT SCORE TO FILE (Format: Name,Level,Time)
             FILE *file = fopen("leaderboard.txt", "a");
@@ -635,44 +968,45 @@
                 // Default to "Unknown" if name somehow empty
                 if (ctx->usernameLen == 0) strcpy(ctx->username, "Unknown");
                 
-                fprintf(file, "%s,%d,%d\n", ctx->username, ctx->currentLevel, currentRunDuration);
+                fprintf(file, "%s,%d,%d\n", ctx->username, ctx->currentLevel, screen->currentRunDuration);
                 fclose(file);
             }
 
             // B. READ ALL SCORES FROM FILE
-            totalScoresLoaded = 0;
+            screen->totalScoresLoaded = 0;
             file = fopen("leaderboard.txt", "r");
             if (file != NULL) {
                 // Scan format: String(up to comma), Integer, Integer
                 // %19[^,] means "Read up to 19 chars or until a comma is found"
                 while (fscanf(file, "%19[^,],%d,%d\n", 
-                    topScores[totalScoresLoaded].name, 
-                    &topScores[totalScoresLoaded].level, 
-                    &topScores[totalScoresLoaded].duration) == 3) 
+                    screen->topScores[screen->totalScoresLoaded].name, 
+                    &screen->topScores[screen->totalScoresLoaded].level, 
+                    &screen->topScores[screen->totalScoresLoaded].duration) == 3) 
                 {
-                    totalScoresLoaded++;
-                    if (totalScoresLoaded >= MAX_LEADERBOARD_ENTRIES) break;
+                    screen->totalScoresLoaded++;
+                    if (screen->totalScoresLoaded >= MAX_LEADERBOARD_ENTRIES) break;
                 }
                 fclose(file);
             }
 
             // C. SORT THE SCORES
-            if (totalScoresLoaded > 0) {
-                qsort(topScores, totalScoresLoaded, sizeof(ScoreEntry), CompareScores);
+            if (screen->totalScoresLoaded > 0) {
+                qsort(screen->topScores, screen->totalScoresLoaded, sizeof(ScoreEntry), CompareScores);
             }
 
-            isDataProcessed = true;
+            screen->processed = true;
         }
 
         // 2. INPUT HANDLING
         if (IsKeyPressed(KEY_ENTER))
         {
-            isDataProcessed = false; 
+            screen->processed = false; 
             
             // Reset Logic
-            ctx->lastGridCellFocused = (Vector2){-1, -1};
-            ctx->gridCellFocused = (Vector2){-1, -1};
-            ctx->frameCount = 0;
+            ctx->lastGridCellFocused = (GridPos){-1, -1};
+            ctx->gridCellFocused = (GridPos){-1, -1};
+            ctx->tickCount = 0;
+            ctx->playTime = 0.0;
             ctx->livesRemaining = 5;
             ctx->currentState = STATE_MENU;
         }
@@ -687,25 +1021,25 @@
             DrawText("GAME OVER", centerX - MeasureText("GAME OVER", 40)/2, y, 40, RED);
             y += 60;
 
-            const char* scoreText = TextFormat("%s, you reached Level %d in %d seconds", ctx->username, ctx->currentLevel, currentRunDuration);
+            const char* scoreText = TextFormat("%s, you reached Level %d in %d seconds", ctx->username, ctx->currentLevel, screen->currentRunDuration);
             DrawText(scoreText, centerX - MeasureText(scoreText, 20)/2, y, 20, YELLOW);
             y += 50;
             
             DrawText("--- LEADERBOARD ---", centerX - MeasureText("--- LEADERBOARD ---", 20)/2, y, 20, WHITE);
             y += 30;
 
-            for (int i = 0; i < totalScoresLoaded && i < LEADERBOARD_DISPLAY_LIMIT; i++) {
+            for (int i = 0; i < screen->totalScoresLoaded && i < LEADERBOARD_DISPLAY_LIMIT; i++) {
                 Color rowColor = (i == 0) ? GOLD : (i == 1) ? LIGHTGRAY : (i == 2) ? BROWN : GRAY;
                 
                 // Format: "1. Name - Lvl 5 - 40s"
                 const char* entryText = TextFormat("%d. %s - Lvl %d - %ds", 
-                    i + 1, topScores[i].name, topScores[i].level, topScores[i].duration);
+                    i + 1, screen->topScores[i].name, screen->topScores[i].level, screen->topScores[i].duration);
                     
                 DrawText(entryText, centerX - MeasureText(entryText, 20)/2, y, 20, rowColor);
                 y += 30;
             }
 
-            if (totalScoresLoaded == 0) {
+            if (screen->totalScoresLoaded == 0) {
                 const char* noScores = "No previous scores found.";
                 DrawText(noScores, centerX - MeasureText(noScores, 20)/2, y, 20, DARKGRAY);
             }
@@ -717,149 +1051,1189 @@
     }
 
 //--------------------------------------------------------------------------------------
-// State Helpers
+// Simulation (no window needed, see RunHeadless)
 //--------------------------------------------------------------------------------------
-    void InitGame(GameContext *ctx) {
-        ctx->currentState = STATE_MENU;
-        ctx->currentLevel = 0;
-        ctx->orbitMode = true;
-        ctx->lastGridCellFocused = (Vector2){-1, -1};
-        ctx->gridCellFocused = (Vector2){-1, -1};
-        ctx->paused = true;
-        ctx->mines = NULL;
-        ctx->mines = malloc(sizeof(MovingEntity));
-        if (ctx->mines == NULL) {
-            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
-            exit(EXIT_FAILURE);
+    // Clears the cell an entity is leaving, unless something else holds it. The robot respawns
+    // without claiming its cell, so a person or mine may be standing there.
+    static void LeaveCell(GameContext *ctx, int x, int y, CellType entityCellType) {
+        if (GetGridCell(ctx, x, y) == entityCellType) SetGridCell(ctx, x, y, CELL_AIR);
+    }
+
+    // Steps the entity at (*x, *y) one cell in dir and resolves what it walks into. A person that
+    // walks into the robot is rescued, leaving *x as ENTITY_DISABLED.
+    void MoveEntity(GameContext *ctx, CellType entityCellType, int *x, int *y, Direction dir) {
+        int futureX = *x + DIR_VECTORS[dir].x;
+        int futureY = *y + DIR_VECTORS[dir].y;
+        // check its not outside the grid
+        if (!IsInsideGrid(ctx, futureX, futureY)) return;
+        
+        // Robots can't occupy the robot respawn point
+        GridPos spawn = GetRobotSpawn(ctx);
+        if (entityCellType == CELL_ROBOT 
+            && futureX == spawn.x 
+            && futureY == spawn.y) {
+                return;
         }
-        ctx->mineCount = 0;
-        ctx->robot.position = (Vector2){4, 4};
-        ctx->robot.moveCooldown = 20;
-        ctx->aiModeEnabled = true;
-        ctx->livesRemaining = MAX_LIVES;
 
-        ctx->peopleMaxMovesPerSec = 3.0f;
-        ctx->minesMaxMovesPerSec = 5.0f;
+        CellType futureCell = GetGridCell(ctx, futureX, futureY);
+        // if robot collides with person
+        if (futureCell == CELL_PERSON && entityCellType == CELL_ROBOT) {
+            ctx->peopleRemaining += -1;
+            // disable the person, found through the cell index
+            int person = EntityIndexFind(&ctx->people.at, CellIndex(ctx->gridWidth, futureX, futureY));
+            if (person != ENTITY_INDEX_NONE) RemoveEntity(ctx, &ctx->people, person);
+            // dont return, which causes the robot to move onwards
+        }
+        // if person collides with robot
+        if (futureCell == CELL_ROBOT && entityCellType == CELL_PERSON) {
+            ctx->peopleRemaining += -1;
+            // disable the person, taking them off the grid too
+            LeaveCell(ctx, *x, *y, entityCellType);
+            *x = ENTITY_DISABLED;
+            *y = ENTITY_DISABLED;
+            return;
+        }
+        // One entity per cell, so nothing walks into a person
+        if (futureCell == CELL_PERSON && entityCellType != CELL_ROBOT) return;
+
+        if (((futureCell == CELL_WALL || futureCell == CELL_MINE) && entityCellType == CELL_ROBOT)
+            || (futureCell == CELL_ROBOT && entityCellType == CELL_MINE) ) {
+                ctx->livesRemaining += -1;
+                // reset pos
+                LeaveCell(ctx, *x, *y, entityCellType);
+                ctx->robot.position = spawn;
+            if (entityCellType == CELL_ROBOT) {
+                *x = spawn.x;
+                *y = spawn.y;
+                return;
+            }
+        }
 
-        ctx->username[0] = '\0';
-        ctx->usernameLen = 0;
-        
-        ctx->AStarHeuristicWeightage = 1.5f;
+        if (futureCell == CELL_WALL || futureCell == CELL_MINE) return;
 
-        // Setup Camera
-        ctx->camera.position = (Vector3){ 0.0f, 20.0f, 20.0f };
-        ctx->camera.target = (Vector3){ GRID_WIDTH*CELL_SIZE/2, 0.0f, GRID_HEIGHT*CELL_SIZE/2 };
-        ctx->camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
-        ctx->camera.fovy = 55.0f;
-        ctx->camera.projection = CAMERA_PERSPECTIVE;
+        LeaveCell(ctx, *x, *y, entityCellType);
+        *x = futureX;
+        *y = futureY;
+        SetGridCell(ctx, futureX, futureY, entityCellType);
+    }
 
-        // Init grid plus shape
-        for (int i=4; i<GRID_WIDTH-4; i++) {ctx->grid[i][GRID_HEIGHT/2] = CELL_WALL;}
-        for (int i=4; i<GRID_HEIGHT-4; i++) {ctx->grid[GRID_WIDTH/2][i] = CELL_WALL;}
+    // One draw per entity decides both of its rolls for the tick: bits 0-14 against the turn
+    // chance, bit 15 which way, bits 16-30 against the move chance. Each entity only touches its
+    // own stream, so this is a straight branch-free pass over the arrays.
+    void RollEntityPool(EntityPool *pool) {
+        for (int i = 0; i < pool->count; i++) {
+            uint32_t roll = NextGameRandom(&pool->rng[i]);
+            uint32_t turn = ((roll & 0x7fff) < pool->turnChance[i]) & (roll >> 15);
+            pool->direction[i] = (uint8_t)((pool->direction[i] + turn) & 3);
+            pool->stepping[i] = ((roll >> 16) & 0x7fff) < pool->moveChance[i];
+        }
+    }
 
-        // Set people random movement speeds
-        ctx->peopleRemaining = NUM_PEOPLE;
-        for (int i=0; i<NUM_PEOPLE; i++) {
-            ctx->people[i].liklihoodToMove = ctx->peopleMaxMovesPerSec * rand() / RAND_MAX / 60.0f;
-            ctx->people[i].liklihoodToTurn = 0.5 * ctx->peopleMaxMovesPerSec * rand() / RAND_MAX / 60.0f;
+    // Rolls the whole pool, then moves the entities that stepped one at a time, in order, since
+    // they can bump into each other
+    void MoveEntityPool(GameContext *ctx, EntityPool *pool, CellType entityCellType) {
+        RollEntityPool(pool);
+        for (int i = 0; i < pool->count; i++) {
+            // if the position is invalid, the entity is disabled and shouldn't be moved
+            if (!pool->stepping[i] || !EntityIsActive(pool, i)) continue;
+            int x = pool->x[i];
+            int y = pool->y[i];
+            MoveEntity(ctx, entityCellType, &x, &y, (Direction)pool->direction[i]);
+            if (x == pool->x[i] && y == pool->y[i]) continue;
+            if (x == ENTITY_DISABLED) RemoveEntity(ctx, pool, i);
+            else PlaceEntity(ctx, pool, i, x, y);
         }
     }
 
-    void AdvanceLevel(GameContext *ctx) {
-        // Wipe the grid of people and mines
-            for(int x=0; x<GRID_WIDTH; x++) {
-                for(int y=0; y<GRID_HEIGHT; y++) {
-                    ctx->grid[x][y] = (ctx->grid[x][y] == CELL_WALL ? CELL_WALL : CELL_AIR);
+    // Puts entity i on (x, y) in the pool and its index. The grid is the caller's to update.
+    void PlaceEntity(GameContext *ctx, EntityPool *pool, int i, int x, int y) {
+        if (EntityIsActive(pool, i)) EntityIndexRemove(&pool->at, CellIndex(ctx->gridWidth, pool->x[i], pool->y[i]));
+        pool->x[i] = (int16_t)x;
+        pool->y[i] = (int16_t)y;
+        EntityIndexInsert(&pool->at, CellIndex(ctx->gridWidth, x, y), i);
+    }
+
+    void RemoveEntity(GameContext *ctx, EntityPool *pool, int i) {
+        if (EntityIsActive(pool, i)) EntityIndexRemove(&pool->at, CellIndex(ctx->gridWidth, pool->x[i], pool->y[i]));
+        pool->x[i] = ENTITY_DISABLED;
+        pool->y[i] = ENTITY_DISABLED;
+    }
+
+    // Person the AI is heading for, or {-1, -1} if everyone is rescued
+    GridPos pick_robot_target(GameContext *ctx) {
+        GridPos startPos = ctx->robot.position;
+        GridPos targetPos = {-1, -1};
+        int shortestDist = 99999;
+
+        if (ctx->plannedRescueOrder) {
+            int person = NextRescueTarget(ctx);
+            if (person != -1) targetPos = EntityPosition(&ctx->people, person);
+        }
+        else for (int i = 0; i < ctx->people.count; i++) {
+            if (EntityIsActive(&ctx->people, i)) {
+                int dist = GetDistance(startPos.x, startPos.y, 
+                                    ctx->people.x[i], ctx->people.y[i]);
+                if (dist < shortestDist) {
+                    shortestDist = dist;
+                    targetPos = EntityPosition(&ctx->people, i);
                 }
             }
-            // Correspondingly, set the mines and persons positions to -1
-                for (int i=0; i<NUM_PEOPLE; i++) {
-                    ctx->people[i].position = (Vector2){-1, -1};
-                }
-                for (int i=0; i<ctx->mineCount; i++) {
-                    ctx->mines[i].position = (Vector2){-1, -1};
-                }
-            
-        ctx->currentLevel += 1;
-        if (!IsKeyDown(KEY_SPACE)) ctx->paused = true; // Pause the game, but if the user has space down, dont
-        ctx->robot.position = (Vector2){3*GRID_HEIGHT/4, GRID_WIDTH/4};
-        ctx->grid[3*GRID_HEIGHT/4][GRID_WIDTH/4] = CELL_ROBOT;
-        const int maxMines = 50;
-        ctx->mineCount = min(5 + (ctx->currentLevel - 1)*2, maxMines);
-        ctx->robot.moveCooldown = max(1, ctx->robot.moveCooldown - 1);
-        if (ctx->robot.moveCooldown > 1) {
-            ctx->robot.moveCooldown += - 1;
-        } else {
-            SetTargetFPS(max(60 + 10*(ctx->currentLevel - 9), 60));
-        }
-        
-        ctx->mines = realloc(ctx->mines, sizeof(MovingEntity)*ctx->mineCount);
-        if (ctx->mines == NULL) {
-            printf("\nrealloc() failed. No free space in memory. Program exiting.\n");
-            exit(EXIT_FAILURE);
         }
+        return targetPos;
+    }
 
-        
-        // Spawn mines and people
-            // Use level number as seed
-            srand(ctx->currentLevel);
+    void move_robot_ai(GameContext *ctx) {
+        // 1. CLEAR PREVIOUS PATH (the path cache may take the rest of it back below)
+        int previousPathLen = ctx->currentPathLen;
+        ctx->currentPathLen = 0;
 
-            // Place people
-            ctx->peopleRemaining = 0;
-            int max_attempts = 10;
-            int x;
-            int y;
-            for (int i=0; i<NUM_PEOPLE; i++) {
-                int attempt = 0;
-                do {
-                    attempt++;
-                    x = rand() % GRID_WIDTH;
-                    y = rand() % GRID_HEIGHT;
+        // Keep the planning window around the robot. Moving it starts every planner over.
+        PrepareAiWindow(ctx);
 
-                    if (ctx->grid[x][y] != CELL_AIR) continue;
-                    ctx->people[i].position = (Vector2){x, y};
-                    ctx->people[i].direction = rand() % 4;
-                    ctx->grid[x][y] = CELL_PERSON;
-                    ctx->peopleRemaining += 1;
+        // Mines have moved since the last tick, so refresh their distance field once here.
+        // Both A* and the fallback then read it in O(1) instead of rescanning neighbourhoods.
+        RefreshMineDanger(ctx);
+
+        // 2. FIND TARGET, in window cells like everything else the planners see
+        GridPos startPos = WorldToWindow(ctx, ctx->robot.position);
+        GridPos targetPos = GetWindowGoal(ctx, pick_robot_target(ctx));
+
+        // If no target, we skip A* and go straight to fallback
+        if (targetPos.x != -1) {
+
+            int startX = startPos.x;
+            int startY = startPos.y;
+            int targetX = targetPos.x;
+            int targetY = targetPos.y;
+
+            if (CheckPathCache(ctx, previousPathLen, startX, startY, targetX, targetY)) {
+                // Nothing on the rest of last tick's path changed, so step along it instead of searching
+                ctx->currentPathLen = previousPathLen - 1;
+                ctx->searchNodesExpanded = 0;
+            }
+            // 3/4. SEARCH with whichever planner is selected
+            else switch (ctx->planner) {
+                case PLANNER_DSTAR_LITE:
+                    PlanPathDStarLite(ctx, startX, startY, targetX, targetY);
+                    break;
+                case PLANNER_FLOW_FIELD:
+                    // Ignores the Manhattan pick and heads for whoever is closest by path
+                    PlanPathFlowField(ctx, startX, startY, targetX, targetY);
+                    break;
+                case PLANNER_JPS:
+                    PlanPathJPS(ctx, startX, startY, targetX, targetY);
+                    break;
+                case PLANNER_HPA:
+                    PlanPathHPA(ctx, startX, startY, targetX, targetY);
+                    break;
+                case PLANNER_SPACETIME:
+                    PlanPathSpaceTime(ctx, startX, startY, targetX, targetY);
+                    break;
+                case PLANNER_ARA:
+                    PlanPathARA(ctx, startX, startY, targetX, targetY);
+                    break;
+                case PLANNER_BIDIRECTIONAL:
+                    PlanPathBidirectional(ctx, startX, startY, targetX, targetY);
+                    break;
+                default:
+                    if (ctx->searchBudgetEnabled) {
+                        // Finish what the frames since the last move didn't, or settle for the best partial path
+                        AdvanceBudgetedAStar(ctx, startX, startY, targetX, targetY);
+                        TraceAStarPath(ctx, startX, startY);
+                        // A finished search is used once so the next one sees fresh mine positions
+                        if (ctx->searchWorkspace.searchFinished) ctx->searchWorkspace.searchActive = false;
+                    }
+                    else PlanPathAStar(ctx, startX, startY, targetX, targetY);
                     break;
-                } while (attempt < max_attempts);            
             }
-            for (int i=0; i<ctx->mineCount; i++) {
-                int attempt = 0;
-                while (attempt < max_attempts) {
-                    attempt++;
-                    x = rand() % GRID_WIDTH;
-                    y = rand() % GRID_HEIGHT;
+            ctx->pathCache.valid = ctx->currentPathLen > 0;
+            ctx->pathCache.planner = ctx->planner;
+            ctx->pathCache.targetX = targetX;
+            ctx->pathCache.targetY = targetY;
+            // The window couldn't get to its end of the tile route, so route again from here next tick
+            if (ctx->currentPathLen == 0 && ctx->window.targetOutside) ctx->router.routeLength = 0;
+        }
 
-                    if (ctx->grid[x][y] != CELL_AIR) continue;
+        // D* Lite only stays valid if it saw every grid change, and the dirty list is about to be emptied
+        if (ctx->planner != PLANNER_DSTAR_LITE || targetPos.x == -1) ctx->dstar.initialised = false;
+        ctx->dirtyCells.count = 0;
+        ctx->dirtyCells.overflowed = false;
 
-                    ctx->mines[i].position = (Vector2){x, y};
-                    ctx->mines[i].direction = rand() % 4;
-                    // Set mines random movement speeds
-                    ctx->mines[i].liklihoodToMove = ctx->minesMaxMovesPerSec * rand() / RAND_MAX / 60.0f;
-                    ctx->mines[i].liklihoodToTurn = 0.5f;
-                    ctx->grid[x][y] = CELL_MINE;
+        // 5. EXECUTE MOVE (Or Fallback)
+        if (ctx->currentPathLen > 0) {
+            GridPos nextStep = ctx->currentPath[ctx->currentPathLen - 1];
+            
+            int dx = nextStep.x - startPos.x;
+            int dy = nextStep.y - startPos.y;
 
-                    break;
+            if (dy == -1) ctx->robot.direction = NORTH;
+            if (dx == 1)  ctx->robot.direction = EAST;
+            if (dy == 1)  ctx->robot.direction = SOUTH;
+            if (dx == -1) ctx->robot.direction = WEST;
+        }
+        else {
+            // FALLBACK: Run the Survival Logic
+            // (This code remains exactly as we wrote it in the previous step)
+            ctx->pathCache.valid = false;
+            int bestScore = -1;
+            GridPos bestMove = {-1, -1};
+            Direction bestDir = ctx->robot.direction; 
+            
+            int dx[] = {0, 1, 0, -1};
+            int dy[] = {-1, 0, 1, 0};
+            Direction dirs[] = {NORTH, EAST, SOUTH, WEST};
+            int startIdx = NextGameRandomBelow(&ctx->robot.rng, 4);
+            int blocked = GetBlockedNeighbours(ctx, startPos.x, startPos.y);
+
+            for (int i = 0; i < 4; i++) {
+                int idx = (startIdx + i) % 4;
+                if (blocked & (1 << idx)) continue;
+                int nx = startPos.x + dx[idx];
+                int ny = startPos.y + dy[idx];
+
+                int score = GetMineSafetyScore(ctx, nx, ny);
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestMove = (GridPos){nx, ny};
+                    bestDir = dirs[idx];
                 }
-                if (attempt >= max_attempts) { printf("Max spawn attempts exceeded."); }            
             }
+            
+            if (bestMove.x != -1) {
+                ctx->robot.direction = bestDir;
+                ctx->currentPath[0] = bestMove;
+                ctx->currentPathLen = 1;
+            } else {
+                ctx->robot.direction = (Direction)((ctx->robot.direction + 2) % 4);
+            }
+        }
+    }
+
+    // One fixed simulation tick, whatever the frame rate
+    void StepGameplay(GameContext *ctx) {
+        double updateStart = GetMonotonicTime();
+        ctx->tickCount++;
+        ctx->playTime += 1.0 / ctx->tickRate;
+
+        // Where everything stood before this tick, for drawing between ticks
+        EntityPool *pools[] = {&ctx->people, &ctx->mines};
+        for (int p = 0; p < 2; p++) {
+            memcpy(pools[p]->previousX, pools[p]->x, sizeof(int16_t) * pools[p]->count);
+            memcpy(pools[p]->previousY, pools[p]->y, sizeof(int16_t) * pools[p]->count);
+        }
+        ctx->robot.previousPosition = ctx->robot.position;
 
+        // Move entities
+            // People
+            MoveEntityPool(ctx, &ctx->people, CELL_PERSON);
+            // Mines
+            MoveEntityPool(ctx, &ctx->mines, CELL_MINE);
+        
+        // Move robot
+        // if ai, then run A* before every move, so both things have the cooldown
+        int effectiveCooldown = ctx->robot.moveCooldown / (1 + ctx->sprintHeld);
+        if (effectiveCooldown < 1) effectiveCooldown = 1;
+        if (ctx->tickCount % effectiveCooldown == 0) {
+            if (ctx->aiModeEnabled) move_robot_ai(ctx);
+            // Move robot
+            // ctx->robot.position;
+            int robotX = ctx->robot.position.x;
+            int robotY = ctx->robot.position.y;
+            MoveEntity(ctx, CELL_ROBOT, &robotX, &robotY, ctx->robot.direction);
+            ctx->robot.position = (GridPos){robotX, robotY};
+        }
+        else if (ctx->aiModeEnabled && ctx->searchBudgetEnabled && ctx->planner == PLANNER_ASTAR) {
+            // Between moves, chip away at the search the next move will need
+            PrepareAiWindow(ctx);
+            GridPos start = WorldToWindow(ctx, ctx->robot.position);
+            GridPos target = GetWindowGoal(ctx, pick_robot_target(ctx));
+            if (target.x != -1) AdvanceBudgetedAStar(ctx, start.x, start.y, target.x, target.y);
+        }
 
+        // check level advancement condition
+        if (ctx->peopleRemaining <= 0) AdvanceLevel(ctx);
+        // check death condition
+        if (ctx->livesRemaining <= 0) ctx->currentState = STATE_GAME_OVER;
+        if (ctx->recorder.file != NULL && ctx->tickCount % REPLAY_CHECKSUM_INTERVAL == 0) WriteReplayChecksum(ctx);
+        RecordUpdateTime(ctx, (float)((GetMonotonicTime() - updateStart) * 1000.0));
     }
 
-//--------------------------------------------------------------------------------------
-// Misc Helpers
-//--------------------------------------------------------------------------------------
-    void UpdateCustomCamera(Camera3D *camera, bool *orbitMode) {
-        float panSensitivity = 0.1f; 
+    // Starts a headless game at level 1 with the AI playing
+    void BeginHeadlessGame(GameContext *ctx) {
+        ctx->aiModeEnabled = true;
+        ctx->currentLevel = 0;
+        AdvanceLevel(ctx);
+        ctx->currentState = STATE_PLAYING;
+        BeginReplayRecording(ctx);
+    }
 
-        // Panning (Middle Mouse)
-        if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE))
-        {
-            Vector2 mouseDelta = GetMouseDelta();
+    // Steps the current level until it is cleared, the robot runs out of lives or
+    // HEADLESS_LEVEL_TIMEOUT passes. Returns true if it was cleared.
+    bool PlayHeadlessLevel(GameContext *ctx, LevelStats *stats) {
+        int startTicks = ctx->tickCount;
+        double startPlayTime = ctx->playTime;
+        int startLives = ctx->livesRemaining;
+        int startHits = ctx->pathCache.hits;
+        int startMisses = ctx->pathCache.misses;
+        stats->level = ctx->currentLevel;
+        stats->people = ctx->peopleRemaining;
+        stats->mines = ctx->mines.count;
+        ctx->updateTimeCount = 0; // p99 over this level only
+        ctx->updateTimeNext = 0;
+
+        while (ctx->currentState == STATE_PLAYING && ctx->currentLevel == stats->level
+               && ctx->playTime - startPlayTime < HEADLESS_LEVEL_TIMEOUT) {
+            StepGameplay(ctx);
+        }
 
-            // Calculate vectors for flat ground movement
+        stats->cleared = ctx->currentLevel != stats->level;
+        stats->outOfLives = ctx->currentState != STATE_PLAYING;
+        stats->ticks = ctx->tickCount - startTicks;
+        stats->simSeconds = ctx->playTime - startPlayTime;
+        stats->livesLost = startLives - ctx->livesRemaining;
+        stats->rescued = stats->cleared ? stats->people : stats->people - ctx->peopleRemaining;
+        stats->cacheHits = ctx->pathCache.hits - startHits;
+        stats->cacheMisses = ctx->pathCache.misses - startMisses;
+        return stats->cleared;
+    }
+
+    // Lets the AI play levels 1..levels with no window, one line of stats per level. Stops early
+    // if the robot runs out of lives or a level is still unsolved after HEADLESS_LEVEL_TIMEOUT.
+    int RunHeadless(GameContext *ctx, int levels) {
+        BeginHeadlessGame(ctx);
+
+        printf("%5s %8s %8s %6s %7s %5s %11s %8s %8s  %s\n",
+               "level", "ticks", "sim_s", "lost", "rescued", "mines", "cache_h/m", "p99_ms", "wall_ms", "result");
+        double runStart = GetMonotonicTime();
+        int cleared = 0;
+        while (ctx->currentState == STATE_PLAYING && ctx->currentLevel <= levels) {
+            LevelStats stats;
+            double levelStart = GetMonotonicTime();
+            bool won = PlayHeadlessLevel(ctx, &stats);
+
+            const char *result = won ? "cleared" : (stats.outOfLives ? "out of lives" : "timed out");
+            printf("%5d %8d %8.1f %6d %4d/%-2d %5d %5d/%-5d %8.3f %8.1f  %s\n",
+                   stats.level, stats.ticks, stats.simSeconds, stats.livesLost, stats.rescued, stats.people, stats.mines,
+                   stats.cacheHits, stats.cacheMisses,
+                   GetUpdateTimePercentile(ctx, 0.99f), (GetMonotonicTime() - levelStart) * 1000.0, result);
+            if (!won) break;
+            cleared++;
+        }
+
+        double wall = GetMonotonicTime() - runStart;
+        printf("Cleared %d/%d levels (seed %u, planner %s): %d ticks, %.1f simulated s in %.3f s wall, %.0f ticks/s\n",
+               cleared, levels, ctx->seed, plannerNames[ctx->planner], ctx->tickCount, ctx->playTime, wall,
+               wall > 0.0 ? ctx->tickCount / wall : 0.0);
+        printf("World: %d of %d tiles populated, %.1f KB. AI: %dx%d window, %.1f KB\n",
+               ctx->world.populatedCount, ctx->world.tilesX * ctx->world.tilesY, WorldMemoryUsed(&ctx->world) / 1024.0,
+               ctx->window.width, ctx->window.height, AiMemoryUsed(ctx) / 1024.0);
+        FinishReplayRecording(ctx);
+        return EXIT_SUCCESS;
+    }
+
+//--------------------------------------------------------------------------------------
+// Batch Runs (many headless games across threads, see RunBatch)
+//--------------------------------------------------------------------------------------
+    // One game per task. Every worker owns a contiguous block of game indices, takes from the
+    // front of it and, once it runs dry, steals the back half of another worker's block. The
+    // block is packed into one word so both ends move with a single compare-and-swap.
+    static inline uint64_t PackBatchRange(uint32_t begin, uint32_t end) {
+        return ((uint64_t)end << 32) | begin;
+    }
+
+    static bool TakeBatchGame(BatchQueue *queue, int *game) {
+        uint64_t range = __atomic_load_n(&queue->range, __ATOMIC_ACQUIRE);
+        for (;;) {
+            uint32_t begin = (uint32_t)range;
+            uint32_t end = (uint32_t)(range >> 32);
+            if (begin >= end) return false;
+            if (__atomic_compare_exchange_n(&queue->range, &range, PackBatchRange(begin + 1, end),
+                                            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                *game = (int)begin;
+                return true;
+            }
+        }
+    }
+
+    // Moves the back half of a victim's block into thief, which must be empty. Game indices are
+    // only ever handed out once, so a stale range can never match again (no ABA).
+    static bool StealBatchGames(BatchQueue *victim, BatchQueue *thief) {
+        uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+        for (;;) {
+            uint32_t begin = (uint32_t)range;
+            uint32_t end = (uint32_t)(range >> 32);
+            if (begin >= end) return false;
+            uint32_t split = end - (end - begin + 1) / 2;
+            if (__atomic_compare_exchange_n(&victim->range, &range, PackBatchRange(begin, split),
+                                            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                __atomic_store_n(&thief->range, PackBatchRange(split, end), __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+    }
+
+    // Plays one whole game in its own context and adds it to the totals
+    static void PlayBatchGame(BatchRun *run, int game) {
+        GameContext *ctx = calloc(1, sizeof(GameContext)); // Too big for a worker's stack on a large arena
+        if (ctx == NULL) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+        InitGame(ctx, run->gridWidth, run->gridHeight, run->baseSeed + (unsigned int)game);
+        ctx->baseTickRate = run->tickRate;
+        ctx->tickRate = run->tickRate;
+        ctx->planner = run->planner;
+        BeginHeadlessGame(ctx);
+
+        int cleared = 0;
+        LevelStats stats = { 0 };
+        while (ctx->currentState == STATE_PLAYING && ctx->currentLevel <= run->levels) {
+            if (!PlayHeadlessLevel(ctx, &stats)) break;
+            cleared++;
+        }
+
+        run->clearedPerGame[game] = cleared;
+        __atomic_fetch_add(&run->levelsCleared, cleared, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&run->ticks, ctx->tickCount, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&run->livesLost, MAX_LIVES - ctx->livesRemaining, __ATOMIC_RELAXED);
+        if (cleared < run->levels && !stats.outOfLives) __atomic_fetch_add(&run->timeouts, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&run->gamesDone, 1, __ATOMIC_RELEASE);
+        FreeGame(ctx);
+        free(ctx);
+    }
+
+    static void* RunBatchWorker(void *arg) {
+        BatchWorker *worker = arg;
+        BatchRun *run = worker->run;
+        BatchQueue *own = &run->queues[worker->index];
+        int game;
+        for (;;) {
+            while (TakeBatchGame(own, &game)) PlayBatchGame(run, game);
+            // Out of work: look for some, starting with the next worker along
+            bool stole = false;
+            for (int i = 1; i < run->threadCount && !stole; i++) {
+                stole = StealBatchGames(&run->queues[(worker->index + i) % run->threadCount], own);
+            }
+            if (!stole) break;
+            __atomic_fetch_add(&run->steals, 1, __ATOMIC_RELAXED);
+        }
+        return NULL;
+    }
+
+    // Plays games seed..seed+games-1 (levels 1..levels each) on threadCount threads and prints the totals
+    int RunBatch(const GameContext *settings, int levels, int games, int threadCount) {
+        if (threadCount > games) threadCount = games;
+
+        BatchRun run = { 0 };
+        run.gridWidth = settings->gridWidth;
+        run.gridHeight = settings->gridHeight;
+        run.tickRate = settings->baseTickRate;
+        run.planner = settings->planner;
+        run.baseSeed = settings->seed;
+        run.levels = levels;
+        run.threadCount = threadCount;
+        run.queues = calloc(threadCount, sizeof(BatchQueue));
+        run.clearedPerGame = calloc(games, sizeof(int));
+        BatchWorker *workers = calloc(threadCount, sizeof(BatchWorker));
+        pthread_t *threads = calloc(threadCount, sizeof(pthread_t));
+        bool *started = calloc(threadCount, sizeof(bool));
+        if (run.queues == NULL || run.clearedPerGame == NULL || workers == NULL || threads == NULL || started == NULL) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+        // Deal the games out in even blocks up front, stealing evens out whatever the levels do
+        for (int i = 0; i < threadCount; i++) {
+            run.queues[i].range = PackBatchRange((uint32_t)((long long)games * i / threadCount),
+                                                 (uint32_t)((long long)games * (i + 1) / threadCount));
+            workers[i].run = &run;
+            workers[i].index = i;
+        }
+
+        double start = GetMonotonicTime();
+        // The calling thread is worker 0. A thread that fails to start just has its block stolen.
+        for (int i = 1; i < threadCount; i++) {
+            started[i] = pthread_create(&threads[i], NULL, RunBatchWorker, &workers[i]) == 0;
+        }
+        RunBatchWorker(&workers[0]);
+        for (int i = 1; i < threadCount; i++) {
+            if (started[i]) pthread_join(threads[i], NULL);
+        }
+        double wall = GetMonotonicTime() - start;
+
+        int fewest = levels, most = 0;
+        for (int i = 0; i < games; i++) {
+            fewest = min(fewest, run.clearedPerGame[i]);
+            most = max(most, run.clearedPerGame[i]);
+        }
+        printf("Batch of %d games, seeds %u..%u, %d levels each, planner %s, %d threads (%lld steals)\n",
+               games, run.baseSeed, run.baseSeed + (unsigned int)(games - 1), levels, plannerNames[run.planner],
+               threadCount, run.steals);
+        printf("Levels cleared: mean %.2f, min %d, max %d. Lives lost: %lld. Timed out: %lld games.\n",
+               (double)run.levelsCleared / games, fewest, most, run.livesLost, run.timeouts);
+        printf("%lld ticks in %.3f s wall: %.1f games/s, %.0f ticks/s\n",
+               run.ticks, wall, wall > 0.0 ? run.gamesDone / wall : 0.0, wall > 0.0 ? run.ticks / wall : 0.0);
+
+        free(run.queues);
+        free(run.clearedPerGame);
+        free(workers);
+        free(threads);
+        free(started);
+        return EXIT_SUCCESS;
+    }
+
+//--------------------------------------------------------------------------------------
+// Replays (--record saves one game's inputs, --replay re-simulates them, see RunReplay)
+//--------------------------------------------------------------------------------------
+    // File layout. Integers are LEB128 varints unless a width is given, fixed-width values are little-endian.
+    //   Header: "RRPL", version (1 byte), seed, grid width, grid height, base tick rate, and the
+    //   settings the game started with: flags (1 byte: AI, rescue order, search budget, path cache,
+    //   sprint from bit 0 up), planner, heuristic weight (4-byte float)
+    //   Records: ticks since the previous record, type (1 byte), payload. Inputs take effect
+    //   before the next tick, checksums (8 bytes) describe the state after their tick, and budget
+    //   records give the budget check that ran out during their tick as the checks since the last one.
+    static void WriteReplayVarint(FILE *file, uint64_t value) {
+        do {
+            int byte = (int)(value & 0x7F);
+            value >>= 7;
+            fputc(value != 0 ? byte | 0x80 : byte, file);
+        } while (value != 0);
+    }
+
+    static void WriteReplayFixed(FILE *file, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) fputc((int)((value >> (8 * i)) & 0xFF), file);
+    }
+
+    static bool ReadReplayVarint(FILE *file, uint64_t *value) {
+        *value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int byte = fgetc(file);
+            if (byte == EOF) return false;
+            *value |= (uint64_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false; // Longer than anything WriteReplayVarint writes
+    }
+
+    static bool ReadReplayFixed(FILE *file, uint64_t *value, int bytes) {
+        *value = 0;
+        for (int i = 0; i < bytes; i++) {
+            int byte = fgetc(file);
+            if (byte == EOF) return false;
+            *value |= (uint64_t)byte << (8 * i);
+        }
+        return true;
+    }
+
+    static uint32_t FloatToBits(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static float BitsToFloat(uint32_t bits) {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static void WriteReplayRecordStart(ReplayRecorder *rec, int tick, int type) {
+        WriteReplayVarint(rec->file, (uint64_t)(tick - rec->lastTick));
+        fputc(type, rec->file);
+        rec->lastTick = tick;
+    }
+
+    static void WriteReplayInput(FILE *file, GameInput input) {
+        switch (input.type) {
+            case INPUT_HEURISTIC_WEIGHT: WriteReplayFixed(file, FloatToBits(input.weight), 4); break;
+            case INPUT_SKIP_LEVEL: break;
+            case INPUT_PAINT: {
+                int fields[] = {input.value, input.from.x, input.from.y, input.to.x, input.to.y};
+                for (int i = 0; i < 5; i++) WriteReplayVarint(file, (uint64_t)fields[i]);
+            } break;
+            default: WriteReplayVarint(file, (uint64_t)input.value); break;
+        }
+    }
+
+    // Reads the payload for input->type. False if the file ends early or the input could never
+    // have come from this arena.
+    static bool ReadReplayInput(FILE *file, const GameContext *ctx, GameInput *input) {
+        uint64_t fields[5];
+        switch (input->type) {
+            case INPUT_HEURISTIC_WEIGHT:
+                if (!ReadReplayFixed(file, &fields[0], 4)) return false;
+                input->weight = BitsToFloat((uint32_t)fields[0]);
+                return true;
+            case INPUT_SKIP_LEVEL:
+                return true;
+            case INPUT_PAINT:
+                for (int i = 0; i < 5; i++) {
+                    if (!ReadReplayVarint(file, &fields[i])) return false;
+                }
+                if ((fields[0] != CELL_AIR && fields[0] != CELL_WALL)
+                    || fields[1] >= (uint64_t)ctx->gridWidth || fields[3] >= (uint64_t)ctx->gridWidth
+                    || fields[2] >= (uint64_t)ctx->gridHeight || fields[4] >= (uint64_t)ctx->gridHeight) return false;
+                input->value = (int)fields[0];
+                input->from = (GridPos){(int16_t)fields[1], (int16_t)fields[2]};
+                input->to = (GridPos){(int16_t)fields[3], (int16_t)fields[4]};
+                return true;
+            default:
+                if (!ReadReplayVarint(file, &fields[0])) return false;
+                input->value = (int)fields[0];
+                if (input->type == INPUT_DIRECTION) return fields[0] < 4;
+                if (input->type == INPUT_PLANNER) return fields[0] < PLANNER_COUNT;
+                return fields[0] <= 1;
+        }
+    }
+
+    // Applies one input to the simulation. Returns false if it changed nothing, which keeps a
+    // mouse held over an already painted cell from adding a record every frame.
+    bool ApplyGameInput(GameContext *ctx, GameInput input) {
+        switch (input.type) {
+            case INPUT_DIRECTION: ctx->robot.direction = (Direction)input.value; break;
+            case INPUT_SPRINT: ctx->sprintHeld = input.value; break;
+            case INPUT_AI_MODE: ctx->aiModeEnabled = input.value; break;
+            case INPUT_HEURISTIC_WEIGHT: ctx->AStarHeuristicWeightage = input.weight; break;
+            case INPUT_PLANNER: ctx->planner = (PathPlanner)input.value; break;
+            case INPUT_RESCUE_ORDER: ctx->plannedRescueOrder = input.value; break;
+            case INPUT_SEARCH_BUDGET: ctx->searchBudgetEnabled = input.value; break;
+            case INPUT_PATH_CACHE: ctx->pathCacheEnabled = input.value; break;
+            case INPUT_SKIP_LEVEL: AdvanceLevel(ctx); break;
+            case INPUT_PAINT: return PaintGridLine(ctx, input.from.x, input.from.y, input.to.x, input.to.y, input.value);
+            default: return false;
+        }
+        return true;
+    }
+
+    // Live input: applied, then saved if the game is being recorded
+    void SubmitGameInput(GameContext *ctx, GameInput input) {
+        if (!ApplyGameInput(ctx, input) || ctx->recorder.file == NULL) return;
+        WriteReplayRecordStart(&ctx->recorder, ctx->tickCount, input.type);
+        WriteReplayInput(ctx->recorder.file, input);
+    }
+
+    static uint64_t HashBytes(uint64_t hash, const void *data, size_t size) {
+        const unsigned char *bytes = data;
+        for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 0x100000001b3ULL; // FNV-1a prime
+        return hash;
+    }
+
+    // FNV-1a over everything a tick carries into the next: the grid, every entity and its random
+    // stream, the robot and the level's counters. Tiles are hashed one by one and combined with
+    // XOR, as the populated list is in no particular order. Values are hashed as they sit in
+    // memory, so replays only check out between machines of the same byte order.
+    uint64_t GetStateChecksum(GameContext *ctx) {
+        const uint64_t basis = 0xcbf29ce484222325ULL; // FNV-1a offset basis
+        uint64_t tiles = 0;
+        for (int t = 0; t < ctx->world.populatedCount; t++) {
+            const WorldTile *tile = ctx->world.populated[t];
+            int origin[] = {tile->originX, tile->originY};
+            tiles ^= HashBytes(HashBytes(basis, origin, sizeof(origin)), tile->cells, sizeof(tile->cells));
+        }
+
+        int counters[] = {ctx->tickCount, ctx->currentLevel, ctx->livesRemaining, ctx->peopleRemaining, ctx->tickRate,
+                          ctx->robot.position.x, ctx->robot.position.y, ctx->robot.direction, ctx->robot.moveCooldown};
+        uint64_t hash = HashBytes(basis ^ tiles, counters, sizeof(counters));
+        hash = HashBytes(hash, &ctx->robot.rng, sizeof(GameRandom));
+        hash = HashBytes(hash, &ctx->budgetChecks, sizeof(ctx->budgetChecks));
+        EntityPool *pools[] = {&ctx->people, &ctx->mines};
+        for (int p = 0; p < 2; p++) {
+            int count = pools[p]->count;
+            hash = HashBytes(hash, &count, sizeof(count));
+            hash = HashBytes(hash, pools[p]->x, sizeof(int16_t) * count);
+            hash = HashBytes(hash, pools[p]->y, sizeof(int16_t) * count);
+            hash = HashBytes(hash, pools[p]->direction, sizeof(uint8_t) * count);
+            hash = HashBytes(hash, pools[p]->rng, sizeof(GameRandom) * count);
+        }
+        return hash;
+    }
+
+    // Opens the --record file as a game starts and saves where it starts from. Does nothing
+    // without --record, or once a game has been recorded.
+    void BeginReplayRecording(GameContext *ctx) {
+        ReplayRecorder *rec = &ctx->recorder;
+        if (rec->path == NULL || rec->file != NULL || rec->finished) return;
+        rec->file = fopen(rec->path, "wb");
+        if (rec->file == NULL) {
+            printf("Could not open %s to record the replay.\n", rec->path);
+            rec->finished = true;
+            return;
+        }
+
+        fputs("RRPL", rec->file);
+        fputc(REPLAY_VERSION, rec->file);
+        WriteReplayVarint(rec->file, ctx->seed);
+        WriteReplayVarint(rec->file, (uint64_t)ctx->gridWidth);
+        WriteReplayVarint(rec->file, (uint64_t)ctx->gridHeight);
+        WriteReplayVarint(rec->file, (uint64_t)ctx->baseTickRate);
+        fputc(ctx->aiModeEnabled | ctx->plannedRescueOrder << 1 | ctx->searchBudgetEnabled << 2
+              | ctx->pathCacheEnabled << 3 | ctx->sprintHeld << 4, rec->file);
+        WriteReplayVarint(rec->file, (uint64_t)ctx->planner);
+        WriteReplayFixed(rec->file, FloatToBits(ctx->AStarHeuristicWeightage), 4);
+        rec->lastTick = ctx->tickCount;
+        // Budget checks are counted from here, as the replay counts them from its start
+        ctx->budgetChecks = 0;
+        rec->lastBudgetSpent = 0;
+    }
+
+    void WriteReplayChecksum(GameContext *ctx) {
+        WriteReplayRecordStart(&ctx->recorder, ctx->tickCount, REPLAY_CHECKSUM);
+        WriteReplayFixed(ctx->recorder.file, GetStateChecksum(ctx), 8);
+    }
+
+    void WriteReplayBudgetSpent(GameContext *ctx) {
+        ReplayRecorder *rec = &ctx->recorder;
+        WriteReplayRecordStart(rec, ctx->tickCount, REPLAY_BUDGET_SPENT);
+        WriteReplayVarint(rec->file, ctx->budgetChecks - rec->lastBudgetSpent);
+        rec->lastBudgetSpent = ctx->budgetChecks;
+    }
+
+    // Ends the recording with the final tick and checksum. Safe to call when nothing is recording.
+    void FinishReplayRecording(GameContext *ctx) {
+        ReplayRecorder *rec = &ctx->recorder;
+        if (rec->file == NULL) return;
+        WriteReplayRecordStart(rec, ctx->tickCount, REPLAY_END);
+        WriteReplayFixed(rec->file, GetStateChecksum(ctx), 8);
+        bool written = !ferror(rec->file);
+        written = fclose(rec->file) == 0 && written;
+        rec->file = NULL;
+        rec->finished = true;
+        if (written) printf("Saved the replay to %s (%d ticks).\n", rec->path, ctx->tickCount);
+        else printf("Could not write the replay to %s.\n", rec->path);
+    }
+
+    // Re-simulates a recorded game with no window, as fast as it will go, checking every checksum
+    // on the way. Returns EXIT_FAILURE if the file can't be read or the game plays out differently.
+    int RunReplay(const char *path) {
+        FILE *file = fopen(path, "rb");
+        if (file == NULL) {
+            printf("Could not open the replay %s.\n", path);
+            return EXIT_FAILURE;
+        }
+        char magic[4];
+        uint64_t version, seed, width, height, tickRate, flags, planner, weightBits;
+        bool readable = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, "RRPL", 4) == 0
+            && ReadReplayFixed(file, &version, 1) && version == REPLAY_VERSION
+            && ReadReplayVarint(file, &seed) && seed <= UINT32_MAX
+            && ReadReplayVarint(file, &width) && width >= MIN_GRID_SIDE && width <= MAX_GRID_SIDE
+            && ReadReplayVarint(file, &height) && height >= MIN_GRID_SIDE && height <= MAX_GRID_SIDE
+            && ReadReplayVarint(file, &tickRate) && tickRate >= 1 && tickRate <= MAX_TICK_RATE
+            && ReadReplayFixed(file, &flags, 1)
+            && ReadReplayVarint(file, &planner) && planner < PLANNER_COUNT
+            && ReadReplayFixed(file, &weightBits, 4);
+        if (!readable) {
+            printf("%s is not a replay this build can play.\n", path);
+            fclose(file);
+            return EXIT_FAILURE;
+        }
+
+        // Start the game the way the recording did
+        GameContext ctx = { 0 };
+        InitGame(&ctx, (int)width, (int)height, (unsigned int)seed);
+        ctx.baseTickRate = (int)tickRate;
+        ctx.tickRate = (int)tickRate;
+        ctx.replayBudgets.active = true;
+        ctx.currentLevel = 0;
+        AdvanceLevel(&ctx);
+        ctx.currentState = STATE_PLAYING;
+        ctx.aiModeEnabled = flags & 1;
+        ctx.plannedRescueOrder = (flags >> 1) & 1;
+        ctx.searchBudgetEnabled = (flags >> 2) & 1;
+        ctx.pathCacheEnabled = (flags >> 3) & 1;
+        ctx.sprintHeld = (flags >> 4) & 1;
+        ctx.planner = (PathPlanner)planner;
+        ctx.AStarHeuristicWeightage = BitsToFloat((uint32_t)weightBits);
+
+        // Step up to each record's tick, then apply or check it
+        const char *problem = NULL;
+        bool diverged = false;
+        uint64_t recorded = 0, actual = 0;
+        int tick = 0;
+        int checksums = 0;
+        uint64_t budgetCheck = 0;
+        double start = GetMonotonicTime();
+        while (problem == NULL) {
+            uint64_t delta, type;
+            if (!ReadReplayVarint(file, &delta) || !ReadReplayFixed(file, &type, 1) || delta > (uint64_t)(INT32_MAX - tick)) {
+                problem = "the file ends before the game does";
+                break;
+            }
+            tick += (int)delta;
+            // A budget runs out partway through its tick, so the replay has to know before that tick plays
+            int stepTo = type == REPLAY_BUDGET_SPENT ? tick - 1 : tick;
+            while (ctx.tickCount < stepTo && ctx.currentState == STATE_PLAYING) StepGameplay(&ctx);
+            if (ctx.tickCount < stepTo) {
+                problem = "the game ended sooner than it did when recorded";
+            } else if (type == REPLAY_BUDGET_SPENT) {
+                ReplayBudgets *budgets = &ctx.replayBudgets;
+                uint64_t checks;
+                if (!ReadReplayVarint(file, &checks) || checks == 0 || budgets->count == REPLAY_BUDGET_QUEUE) {
+                    problem = "a budget record is damaged";
+                } else {
+                    budgetCheck += checks;
+                    budgets->spentAt[budgets->count++] = budgetCheck;
+                }
+            } else if (type == REPLAY_CHECKSUM || type == REPLAY_END) {
+                if (!ReadReplayFixed(file, &recorded, 8)) {
+                    problem = "the file ends before the game does";
+                } else if ((actual = GetStateChecksum(&ctx)) != recorded) {
+                    problem = "the state differs from the recording";
+                    diverged = true;
+                } else {
+                    checksums++;
+                    if (type == REPLAY_END) break;
+                }
+            } else if (type < INPUT_COUNT) {
+                GameInput input = {.type = (InputType)type};
+                if (ReadReplayInput(file, &ctx, &input)) ApplyGameInput(&ctx, input);
+                else problem = "an input record is damaged";
+            } else {
+                problem = "a record has an unknown type";
+            }
+        }
+        double wall = GetMonotonicTime() - start;
+        fclose(file);
+
+        if (problem != NULL) {
+            printf("Replay %s failed at tick %d (level %d): %s.\n", path, ctx.tickCount, ctx.currentLevel, problem);
+            if (diverged) printf("Checksum %016llx, recorded %016llx.\n", (unsigned long long)actual, (unsigned long long)recorded);
+        } else {
+            printf("Replayed %s: %d ticks to level %d with %d lives left, %d checksums matched.\n",
+                   path, ctx.tickCount, ctx.currentLevel, ctx.livesRemaining, checksums);
+            printf("%.1f simulated s in %.3f s wall: %.0fx real time, %.0f ticks/s\n", ctx.playTime, wall,
+                   wall > 0.0 ? ctx.playTime / wall : 0.0, wall > 0.0 ? ctx.tickCount / wall : 0.0);
+        }
+        FreeGame(&ctx);
+        return problem != NULL ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+//--------------------------------------------------------------------------------------
+// State Helpers
+//--------------------------------------------------------------------------------------
+    void InitGame(GameContext *ctx, int gridWidth, int gridHeight, unsigned int seed) {
+        ctx->seed = seed;
+        ctx->gridWidth = gridWidth;
+        ctx->gridHeight = gridHeight;
+        ctx->cellCount = gridWidth * gridHeight;
+        if (!InitWorld(&ctx->world, gridWidth, gridHeight)) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+        ctx->currentState = STATE_MENU;
+        ctx->currentLevel = 0;
+        ctx->orbitMode = true;
+        ctx->lastGridCellFocused = (GridPos){-1, -1};
+        ctx->gridCellFocused = (GridPos){-1, -1};
+        ctx->paused = true;
+        ReserveEntityPool(&ctx->people, NUM_PEOPLE);
+        ctx->people.count = NUM_PEOPLE;
+        for (int i=0; i<NUM_PEOPLE; i++) ctx->people.x[i] = ENTITY_DISABLED;
+        ctx->mines.count = 0;
+        ctx->robot.position = (GridPos){4, 4};
+        ctx->robot.moveCooldown = 20;
+        ctx->baseTickRate = DEFAULT_TICK_RATE;
+        ctx->tickRate = DEFAULT_TICK_RATE;
+        ctx->aiModeEnabled = true;
+        ctx->livesRemaining = MAX_LIVES;
+
+        ctx->peopleMaxMovesPerSec = 3.0f;
+        ctx->minesMaxMovesPerSec = 5.0f;
+
+        ctx->username[0] = '\0';
+        ctx->usernameLen = 0;
+        
+        ctx->AStarHeuristicWeightage = 1.5f;
+        ctx->searchNodeBudget = SEARCH_NODE_BUDGET;
+        ctx->pathCacheEnabled = true;
+        ctx->searchTimeBudgetUs = SEARCH_TIME_BUDGET_US;
+
+        // Setup Camera
+        ctx->camera.position = (Vector3){ 0.0f, 20.0f, 20.0f };
+        ctx->camera.target = (Vector3){ ctx->gridWidth*CELL_SIZE/2, 0.0f, ctx->gridHeight*CELL_SIZE/2 };
+        ctx->camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+        ctx->camera.fovy = 55.0f;
+        ctx->camera.projection = CAMERA_PERSPECTIVE;
+
+        // Init grid plus shape
+        for (int i=4; i<ctx->gridWidth-4; i++) {PutWorldCell(ctx, i, ctx->gridHeight/2, CELL_WALL);}
+        for (int i=4; i<ctx->gridHeight-4; i++) {PutWorldCell(ctx, ctx->gridWidth/2, i, CELL_WALL);}
+        MarkAllCellsDirty(ctx);
+
+        // Set people random movement speeds, from their level 0 streams
+        ctx->peopleRemaining = NUM_PEOPLE;
+        for (int i=0; i<NUM_PEOPLE; i++) {
+            GameRandom *rng = &ctx->people.rng[i];
+            SeedLevelRandom(ctx, rng, RANDOM_STREAM_PERSON(i));
+            ctx->people.moveChance[i] = (uint16_t)(ENTITY_CHANCE_ONE * ctx->peopleMaxMovesPerSec * NextGameRandomFloat(rng) / DEFAULT_TICK_RATE);
+            ctx->people.turnChance[i] = (uint16_t)(ENTITY_CHANCE_ONE * 0.5f * ctx->peopleMaxMovesPerSec * NextGameRandomFloat(rng) / DEFAULT_TICK_RATE);
+        }
+    }
+
+    // Releases everything InitGame, the levels and the AI since allocated
+    void FreeGame(GameContext *ctx) {
+        if (ctx->cellStorage != NULL) {
+            OpenSet *queues[] = {&ctx->searchWorkspace.openSet, &ctx->reverseWorkspace.openSet,
+                                 &ctx->dstar.queue, &ctx->hpa.queue, &ctx->spaceTime.queue};
+            for (int i = 0; i < 5; i++) {
+                free(queues[i]->items);
+                queues[i]->items = NULL;
+            }
+            FreeGridBitboards(&ctx->bitboards);
+            FreeTileRouter(&ctx->router);
+        }
+        free(ctx->cellStorage);
+        ctx->cellStorage = NULL;
+        FreeEntityPool(&ctx->people);
+        FreeEntityPool(&ctx->mines);
+        FreeWorld(&ctx->world);
+    }
+
+    // Hands out the next piece of the cell storage block. Without a block it only counts, which
+    // is how AllocateCellStorage sizes the block before carving it up.
+    static void* CarveCellStorage(unsigned char *block, size_t *used, size_t bytes) {
+        void *piece = (block != NULL) ? block + *used : NULL;
+        *used += (bytes + 15) & ~(size_t)15; // Keeps every array 16-byte aligned
+        return piece;
+    }
+
+    // Points every array sized by the window at its slice of block, returning the bytes used
+    static size_t LayoutCellStorage(GameContext *ctx, unsigned char *block) {
+        size_t used = 0;
+        size_t cells = (size_t)ctx->window.cellCount;
+        size_t boxCells = (size_t)ctx->spaceTime.cellCount;
+        size_t layers = SPACETIME_HORIZON + 1;
+        size_t clusters = (size_t)ctx->hpa.clustersX * ctx->hpa.clustersY;
+
+        ctx->currentPath = CarveCellStorage(block, &used, sizeof(GridPos) * cells);
+        ctx->searchWorkspace.nodes = CarveCellStorage(block, &used, sizeof(Node) * cells);
+        ctx->reverseWorkspace.nodes = CarveCellStorage(block, &used, sizeof(Node) * cells);
+        ctx->dstar.nodes = CarveCellStorage(block, &used, sizeof(Node) * cells);
+        ctx->dstar.rhs = CarveCellStorage(block, &used, sizeof(int) * cells);
+        ctx->dstar.cost = CarveCellStorage(block, &used, sizeof(int) * cells);
+        ctx->jps.jumpDistance[0] = CarveCellStorage(block, &used, sizeof(int) * cells);
+        ctx->jps.jumpDistance[1] = CarveCellStorage(block, &used, sizeof(int) * cells);
+        ctx->jps.hazardPrefix = CarveCellStorage(block, &used, sizeof(int) * ctx->window.width * (ctx->window.height + 1));
+        ctx->hpa.active = CarveCellStorage(block, &used, sizeof(bool) * clusters * HPA_SLOTS_PER_CLUSTER);
+        ctx->hpa.distance = CarveCellStorage(block, &used, sizeof(short) * clusters * HPA_SLOTS_PER_CLUSTER * HPA_SLOTS_PER_CLUSTER);
+        ctx->hpa.clusterStale = CarveCellStorage(block, &used, sizeof(bool) * clusters);
+        ctx->hpa.nodes = CarveCellStorage(block, &used, sizeof(Node) * (ctx->hpa.nodeCount + 2));
+        ctx->ara.inconsistent = CarveCellStorage(block, &used, sizeof(bool) * cells);
+        ctx->ara.inconsistentNodes = CarveCellStorage(block, &used, sizeof(Node*) * cells);
+        ctx->ara.closedNodes = CarveCellStorage(block, &used, sizeof(Node*) * cells);
+        ctx->spaceTime.reservation = CarveCellStorage(block, &used, sizeof(float) * layers * boxCells);
+        ctx->spaceTime.nodes = CarveCellStorage(block, &used, sizeof(Node) * layers * boxCells);
+        ctx->spaceTime.pathRisk = CarveCellStorage(block, &used, sizeof(float) * layers * boxCells);
+        ctx->spaceTime.goalDistance = CarveCellStorage(block, &used, sizeof(int) * cells);
+        ctx->spaceTime.frontier = CarveCellStorage(block, &used, sizeof(int) * cells);
+        ctx->spaceTime.stateSlot = CarveCellStorage(block, &used, 4 * cells);
+        ctx->rescuePlan.distance = CarveCellStorage(block, &used, sizeof(int) * NUM_PEOPLE * cells);
+        ctx->rescuePlan.frontier = CarveCellStorage(block, &used, sizeof(int) * cells);
+        return used;
+    }
+
+    // Sizes everything that depends on the window dimensions and allocates all of it as one zeroed block
+    void AllocateCellStorage(GameContext *ctx) {
+        HierarchicalMap *hpa = &ctx->hpa;
+        hpa->clustersX = (ctx->window.width + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+        hpa->clustersY = (ctx->window.height + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+        hpa->nodeCount = hpa->clustersX * hpa->clustersY * HPA_SLOTS_PER_CLUSTER;
+
+        SearchWorkspace *workspaces[] = {&ctx->searchWorkspace, &ctx->reverseWorkspace};
+        for (int i = 0; i < 2; i++) {
+            workspaces[i]->width = ctx->window.width;
+            workspaces[i]->height = ctx->window.height;
+        }
+        ctx->dstar.width = ctx->window.width;
+        ctx->dstar.height = ctx->window.height;
+        ctx->spaceTime.width = SPACETIME_BOX_SIDE;
+        ctx->spaceTime.height = SPACETIME_BOX_SIDE;
+        ctx->spaceTime.cellCount = SPACETIME_BOX_SIDE * SPACETIME_BOX_SIDE;
+
+        ctx->cellStorageBytes = LayoutCellStorage(ctx, NULL);
+        ctx->cellStorage = calloc(1, ctx->cellStorageBytes);
+        if (ctx->cellStorage == NULL) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+        LayoutCellStorage(ctx, ctx->cellStorage);
+    }
+
+    // Everything the AI plans with, sized by the planning window rather than the arena. Only called
+    // once the AI first plans, so a game played by hand never allocates any of it.
+    void AllocateAiState(GameContext *ctx) {
+        PlanningWindow *window = &ctx->window;
+        window->width = min(ctx->gridWidth, AI_WINDOW_SIDE);
+        window->height = min(ctx->gridHeight, AI_WINDOW_SIDE);
+        window->cellCount = window->width * window->height;
+        window->placed = false;
+        AllocateCellStorage(ctx);
+        // Only an arena the window can't hold needs routes across it
+        bool routed = window->width < ctx->gridWidth || window->height < ctx->gridHeight;
+        if (!InitGridBitboards(&ctx->bitboards, window->width, window->height)
+            || !InitOpenSet(&ctx->searchWorkspace.openSet, window->cellCount)
+            || !InitOpenSet(&ctx->reverseWorkspace.openSet, window->cellCount)
+            || !InitOpenSet(&ctx->dstar.queue, window->cellCount)
+            || !InitOpenSet(&ctx->hpa.queue, ctx->hpa.nodeCount + 2)
+            || !InitOpenSet(&ctx->spaceTime.queue, (SPACETIME_HORIZON + 1) * ctx->spaceTime.cellCount)
+            || (routed && !InitTileRouter(&ctx->router, ctx->world.tilesX, ctx->world.tilesY))) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Bytes the AI holds for its window and routes, 0 until it first plans
+    size_t AiMemoryUsed(const GameContext *ctx) {
+        if (ctx->cellStorage == NULL) return 0;
+        const PlanningWindow *window = &ctx->window;
+        size_t rowWords = (size_t)(window->width + 63) / 64;
+        size_t bitboards = (4 + MINE_SAFETY_RADIUS + 1 + 2 * MINE_SAFETY_RADIUS + 1) * rowWords * window->height * sizeof(uint64_t);
+        size_t queues = sizeof(Node*) * (3 * (size_t)window->cellCount + ctx->hpa.nodeCount + 2
+                                         + (SPACETIME_HORIZON + 1) * (size_t)ctx->spaceTime.cellCount);
+        return ctx->cellStorageBytes + bitboards + queues + TileRouterMemoryUsed(&ctx->router);
+    }
+
+    // Points the pool's arrays at their slices of block, returning the bytes used
+    static size_t LayoutEntityPool(EntityPool *pool, unsigned char *block, int capacity) {
+        size_t used = 0;
+        size_t count = (size_t)capacity;
+        pool->rng = CarveCellStorage(block, &used, sizeof(GameRandom) * count);
+        pool->x = CarveCellStorage(block, &used, sizeof(int16_t) * count);
+        pool->y = CarveCellStorage(block, &used, sizeof(int16_t) * count);
+        pool->previousX = CarveCellStorage(block, &used, sizeof(int16_t) * count);
+        pool->previousY = CarveCellStorage(block, &used, sizeof(int16_t) * count);
+        pool->moveChance = CarveCellStorage(block, &used, sizeof(uint16_t) * count);
+        pool->turnChance = CarveCellStorage(block, &used, sizeof(uint16_t) * count);
+        pool->direction = CarveCellStorage(block, &used, sizeof(uint8_t) * count);
+        pool->stepping = CarveCellStorage(block, &used, sizeof(uint8_t) * count);
+        return used;
+    }
+
+    // Makes room for capacity entities. Growing starts the pool over, zeroed and with an empty index,
+    // as every level respawns its entities anyway.
+    void ReserveEntityPool(EntityPool *pool, int capacity) {
+        if (pool->block != NULL && capacity <= pool->capacity) return;
+        free(pool->block);
+        FreeEntityIndex(&pool->at);
+        pool->block = calloc(1, LayoutEntityPool(pool, NULL, capacity));
+        if (pool->block == NULL || !InitEntityIndex(&pool->at, capacity)) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+        LayoutEntityPool(pool, pool->block, capacity);
+        pool->capacity = capacity;
+        pool->count = 0;
+    }
+
+    void FreeEntityPool(EntityPool *pool) {
+        free(pool->block);
+        FreeEntityIndex(&pool->at);
+        pool->block = NULL;
+        pool->capacity = 0;
+        pool->count = 0;
+    }
+
+    void AdvanceLevel(GameContext *ctx) {
+        // Wipe the grid of people and mines. Going backwards, a tile that empties swaps in one already visited.
+            for (int t = ctx->world.populatedCount - 1; t >= 0; t--) {
+                WorldTile *tile = ctx->world.populated[t];
+                for (int i = 0; i < WORLD_TILE_SIZE * WORLD_TILE_SIZE; i++) {
+                    int cell = tile->cells[i];
+                    if (cell == CELL_AIR || cell == CELL_WALL) continue;
+                    PutWorldCell(ctx, tile->originX + i % WORLD_TILE_SIZE, tile->originY + i / WORLD_TILE_SIZE, CELL_AIR);
+                }
+            }
+            // Correspondingly, set the mines and persons positions to -1
+                for (int i=0; i<ctx->people.count; i++) {
+                    ctx->people.x[i] = ENTITY_DISABLED;
+                }
+                ClearEntityIndex(&ctx->people.at);
+                ClearEntityIndex(&ctx->mines.at);
+            
+        ctx->currentLevel += 1;
+        if (!ctx->spaceHeld) ctx->paused = true; // Pause the game, but if the user has space down, dont
+        ctx->robot.position = GetRobotSpawn(ctx);
+        PutWorldCell(ctx, ctx->robot.position.x, ctx->robot.position.y, CELL_ROBOT);
+        const int maxMines = max(ctx->cellCount / CELLS_PER_MINE_CAP, 5);
+        int mineCount = min(5 + (ctx->currentLevel - 1)*2, maxMines);
+        ctx->robot.moveCooldown = max(1, ctx->robot.moveCooldown - 1);
+        if (ctx->robot.moveCooldown > 1) {
+            ctx->robot.moveCooldown += - 1;
+        } else {
+            // Past that the whole simulation speeds up, +1/6 of the base rate per level from level 10
+            ctx->tickRate = ctx->baseTickRate * max(6 + (ctx->currentLevel - 9), 6) / 6;
+        }
+        
+        ReserveEntityPool(&ctx->mines, mineCount);
+        ctx->mines.count = mineCount;
+        for (int i=0; i<mineCount; i++) ctx->mines.x[i] = ENTITY_DISABLED; // Until spawned
+
+        
+        // Spawn mines and people
+            // Use level number as seed, varied by --seed. Where things spawn comes from the layout
+            // stream, everything about each entity from its own.
+            SeedLevelRandom(ctx, &ctx->rng, RANDOM_STREAM_LAYOUT);
+            SeedLevelRandom(ctx, &ctx->robot.rng, RANDOM_STREAM_ROBOT);
+
+            // Place people
+            ctx->peopleRemaining = 0;
+            int max_attempts = 10;
+            int x;
+            int y;
+            for (int i=0; i<NUM_PEOPLE; i++) {
+                SeedLevelRandom(ctx, &ctx->people.rng[i], RANDOM_STREAM_PERSON(i));
+                int attempt = 0;
+                do {
+                    attempt++;
+                    x = NextGameRandomBelow(&ctx->rng, ctx->gridWidth);
+                    y = NextGameRandomBelow(&ctx->rng, ctx->gridHeight);
+
+                    if (GetGridCell(ctx, x, y) != CELL_AIR) continue;
+                    PlaceEntity(ctx, &ctx->people, i, x, y);
+                    ctx->people.direction[i] = (uint8_t)NextGameRandomBelow(&ctx->people.rng[i], 4);
+                    PutWorldCell(ctx, x, y, CELL_PERSON);
+                    ctx->peopleRemaining += 1;
+                    break;
+                } while (attempt < max_attempts);            
+            }
+            for (int i=0; i<ctx->mines.count; i++) {
+                SeedLevelRandom(ctx, &ctx->mines.rng[i], RANDOM_STREAM_MINE(i));
+                int attempt = 0;
+                while (attempt < max_attempts) {
+                    attempt++;
+                    x = NextGameRandomBelow(&ctx->rng, ctx->gridWidth);
+                    y = NextGameRandomBelow(&ctx->rng, ctx->gridHeight);
+
+                    if (GetGridCell(ctx, x, y) != CELL_AIR) continue;
+
+                    PlaceEntity(ctx, &ctx->mines, i, x, y);
+                    ctx->mines.direction[i] = (uint8_t)NextGameRandomBelow(&ctx->mines.rng[i], 4);
+                    // Set mines random movement speeds
+                    ctx->mines.moveChance[i] = (uint16_t)(ENTITY_CHANCE_ONE * ctx->minesMaxMovesPerSec * NextGameRandomFloat(&ctx->mines.rng[i]) / DEFAULT_TICK_RATE);
+                    ctx->mines.turnChance[i] = ENTITY_CHANCE_ONE / 2;
+                    PutWorldCell(ctx, x, y, CELL_MINE);
+
+                    break;
+                }
+                if (attempt >= max_attempts) { printf("Max spawn attempts exceeded."); }            
+            }
+
+        // The whole layout changed, so incremental planners must start over
+        MarkAllCellsDirty(ctx);
+
+
+    }
+
+//--------------------------------------------------------------------------------------
+// Misc Helpers
+//--------------------------------------------------------------------------------------
+    void UpdateCustomCamera(Camera3D *camera, bool *orbitMode) {
+        float panSensitivity = 0.1f; 
+
+        // Panning (Middle Mouse)
+        if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE))
+        {
+            Vector2 mouseDelta = GetMouseDelta();
+
+            // Calculate vectors for flat ground movement
             Vector3 forward = Vector3Subtract(camera->target, camera->position);
             Vector3 right = Vector3CrossProduct(forward, (Vector3){ 0.0f, 1.0f, 0.0f });
             right = Vector3Normalize(right);
@@ -913,24 +2287,22 @@
             int gridY = (int)(hitPoint.z / CELL_SIZE);
 
             // Check if inside Grid Boundaries
-            if (gridX >= 0 && gridX < GRID_WIDTH && gridY >= 0 && gridY < GRID_HEIGHT)
+            if (IsInsideGrid(ctx, gridX, gridY))
             {
-                ctx->gridCellFocused = (Vector2){ (float)gridX, (float)gridY };
+                ctx->gridCellFocused = (GridPos){gridX, gridY};
 
                 // Handle Painting
                 if (ctx->aiModeEnabled && (IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT)))
                 {
-                    int paintValue = IsMouseButtonDown(MOUSE_BUTTON_LEFT) ? CELL_WALL : CELL_AIR;
+                    GameInput stroke = {.type = INPUT_PAINT, .from = ctx->gridCellFocused, .to = ctx->gridCellFocused};
+                    stroke.value = IsMouseButtonDown(MOUSE_BUTTON_LEFT) ? CELL_WALL : CELL_AIR;
 
                     // Interpolate line if we have a valid previous position to prevent gaps
                     if (ctx->lastGridCellFocused.x != -1 && ctx->lastGridCellFocused.y != -1)
                     {
-                        PaintGridLine(ctx, (int)ctx->lastGridCellFocused.x, (int)ctx->lastGridCellFocused.y, gridX, gridY, paintValue);
-                    }
-                    else
-                    {
-                        ctx->grid[gridX][gridY] = paintValue;
+                        stroke.from = ctx->lastGridCellFocused;
                     }
+                    SubmitGameInput(ctx, stroke);
                 }
                 
                 ctx->lastGridCellFocused = ctx->gridCellFocused;
@@ -939,7 +2311,7 @@
         }
 
         // If we missed the floor or the grid, invalidate history
-        ctx->lastGridCellFocused = (Vector2){ -1, -1 };
+        ctx->lastGridCellFocused = (GridPos){-1, -1};
     }
 
     // This code is not mine. I took it from an example from the raylib github repo
@@ -1049,8 +2421,8 @@
 
     void DrawGameScene(GameContext *ctx) {
         void Draw3DHUD(GameContext *ctx) {
-            float worldWidth = GRID_WIDTH * CELL_SIZE;
-            float worldHeight = GRID_HEIGHT * CELL_SIZE;
+            float worldWidth = ctx->gridWidth * CELL_SIZE;
+            float worldHeight = ctx->gridHeight * CELL_SIZE;
             
             // Config
             float fontSize = 3.0f;
@@ -1063,7 +2435,7 @@
 
             // --- NORTH EDGE (Controls) ---
             rlPushMatrix();
-                const char* txtNorth = "L-Click : Paint | R-Click : Erase | M-Click : Pan | O : Orbit\n Space : Pause | L-Shift : Sprint | </> : change A* Heuristic weighting";
+                const char* txtNorth = "L-Click : Paint | R-Click : Erase | M-Click : Pan | O : Orbit\n Space : Pause | L-Shift : Sprint | </> : change A* Heuristic weighting | P : Planner | R : Rescue order | B : Search budget | C : Path cache";
                 // Measure exact width
                 float widthN = MeasureTextEx(font, txtNorth, (float)font.baseSize, 1.0f).x * fontScale;
                 
@@ -1108,7 +2480,14 @@
 
             // --- WEST EDGE (Mode) ---
             rlPushMatrix();
-                const char* txtWest = TextFormat("Mode: %s\nA* Heuristic weighting: %.2f", ctx->aiModeEnabled ? "AI" : "MANUAL", ctx->AStarHeuristicWeightage);
+                const char* txtWest = TextFormat("Mode: %s\nPlanner: %s\nA* Heuristic weighting: %.2f\nNodes expanded: %d\n"
+                                                 "Rescue order: %s\nSearch budget: %s\nPath cache: %s (%d hits / %d misses)\n"
+                                                 "Update p99: %.3f ms\nWorld: %d tiles, %.0f KB",
+                                                 ctx->aiModeEnabled ? "AI" : "MANUAL", plannerNames[ctx->planner], ctx->AStarHeuristicWeightage, ctx->searchNodesExpanded,
+                                                 ctx->plannedRescueOrder ? "Planned tour" : "Nearest first", ctx->searchBudgetEnabled ? "On" : "Off",
+                                                 ctx->pathCacheEnabled ? "On" : "Off", ctx->pathCache.hits, ctx->pathCache.misses,
+                                                 GetUpdateTimePercentile(ctx, 0.99f), ctx->world.populatedCount, WorldMemoryUsed(&ctx->world) / 1024.0);
+                const int westLines = 9; // Lines in txtWest, the ARA* bound goes below them
                 float widthW = MeasureTextEx(font, txtWest, (float)font.baseSize, 1.0f).x * fontScale;
 
                 // Position: Left Center, outside (-X)
@@ -1128,6 +2507,12 @@
                 }
 
                 DrawText3D(font, txtWest, (Vector3){0,0,-6.0f}, fontSize, spacing, 0, true, BLUE);
+
+                // Draw the ARA* bound (Below the block, only while ARA* plans)
+                if (ctx->planner == PLANNER_ARA) {
+                    const char* txtBound = TextFormat("Bound reached: %.2f", ctx->ara.boundReached);
+                    DrawText3D(font, txtBound, (Vector3){0, 0, -6.0f + westLines*fontSize}, fontSize, spacing, 0, true, BLUE);
+                }
             rlPopMatrix();
 
 
@@ -1233,8 +2618,8 @@
 
         // Calculates pentagon positions on the fly and draws the batteries
         void DrawBatteries(GameContext *ctx) {
-            float centerX = (GRID_WIDTH * CELL_SIZE) / 2.0f;
-            float centerZ = (GRID_HEIGHT * CELL_SIZE) / 2.0f;
+            float centerX = (ctx->gridWidth * CELL_SIZE) / 2.0f;
+            float centerZ = (ctx->gridHeight * CELL_SIZE) / 2.0f;
             
             // Angle between batteries (360 / 5 = 72 degrees)
             float angleStep = 2.0f * PI / MAX_LIVES;
@@ -1248,9 +2633,9 @@
 
                 // 1. Calculate Position
                 Vector3 pos;
-                pos.x = centerX + sinf(angle) * BATTERY_RADIUS;
+                pos.x = centerX + sinf(angle) * BATTERY_RADIUS(ctx->gridWidth);
                 pos.y = 0.0f; // On floor
-                pos.z = centerZ + cosf(angle) * BATTERY_RADIUS;
+                pos.z = centerZ + cosf(angle) * BATTERY_RADIUS(ctx->gridWidth);
 
                 // 2. Calculate Rotation
                 // We convert the placement angle to degrees.
@@ -1267,7 +2652,26 @@
             }
         }
         
-        void DrawDirectionalEyes(MovingEntity *entity) {
+        // Between ticks entities slide from their previous cell towards the current one. Anything
+        // that jumped (a respawn, a new level) is drawn where it is now.
+        float tickAlpha = Clamp((float)(ctx->tickAccumulator * ctx->tickRate), 0.0f, 1.0f);
+        Vector2 GetDrawPosition(GridPos position, GridPos from) {
+            Vector2 at = { position.x, position.y };
+            if (abs(from.x - position.x) + abs(from.y - position.y) != 1) return at;
+            return Vector2Lerp((Vector2){ from.x, from.y }, at, tickAlpha);
+        }
+
+        Vector2 GetPoolDrawPosition(EntityPool *pool, int i) {
+            return GetDrawPosition(EntityPosition(pool, i), (GridPos){pool->previousX[i], pool->previousY[i]});
+        }
+
+        void DrawEntityCube(Vector2 at, CellType cellType) {
+            Vector3 cellPos = { (at.x * CELL_SIZE) + CELL_SIZE/2, 0.0f, (at.y * CELL_SIZE) + CELL_SIZE/2 };
+            DrawCube(cellPos, CELL_SIZE, CELL_SIZE, CELL_SIZE, cellFillColours[cellType-1]);
+            DrawCubeWires(cellPos, CELL_SIZE, CELL_SIZE, CELL_SIZE, cellOutlineColours[cellType-1]);
+        }
+
+        void DrawDirectionalEyes(Vector2 at, Direction direction) {
             // 1. Define constants to remove magic numbers
             float eyeSize = CELL_SIZE / 3.0f;
             float pupilSize = CELL_SIZE / 6.0f;
@@ -1277,14 +2681,14 @@
             float pupilOffset = offset + (eyeSize - pupilSize)/2 + 0.06f; 
             // 2. Calculate World Position of the entity center
             Vector3 centerPos = {
-                (entity->position.x * CELL_SIZE) + CELL_SIZE/2, 
+                (at.x * CELL_SIZE) + CELL_SIZE/2, 
                 0.0f, 
-                (entity->position.y * CELL_SIZE) + CELL_SIZE/2
+                (at.y * CELL_SIZE) + CELL_SIZE/2
             };
 
             // 3. Convert Direction Enum (0-3) to Degrees (0, -90, -180, -270)
             // We multiply by -90 because Raylib's 3D rotation usually goes counter-clockwise
-            float rotationAngle = entity->direction * -90.0f; 
+            float rotationAngle = direction * -90.0f; 
 
             // 4. Matrix Transformation
             rlPushMatrix();
@@ -1314,21 +2718,23 @@
         rlDrawRenderBatchActive();
         rlEnableDepthMask();
 
-        // Draw A* path
+        // Draw A* path (planned in window cells)
         if (ctx->aiModeEnabled && ctx->currentPathLen > 0) {
             // Draw line from robot to first node
+            Vector2 robotAt = GetDrawPosition(ctx->robot.position, ctx->robot.previousPosition);
             Vector3 start = { 
-                (ctx->robot.position.x * CELL_SIZE) + CELL_SIZE/2, 
+                (robotAt.x * CELL_SIZE) + CELL_SIZE/2, 
                 0.5f, 
-                (ctx->robot.position.y * CELL_SIZE) + CELL_SIZE/2 
+                (robotAt.y * CELL_SIZE) + CELL_SIZE/2 
             };
             
             // Draw the rest of the path
             for (int i = ctx->currentPathLen - 1; i >= 0; i--) {
+                GridPos cell = WindowToWorld(ctx, ctx->currentPath[i]);
                 Vector3 end = { 
-                    (ctx->currentPath[i].x * CELL_SIZE) + CELL_SIZE/2, 
+                    (cell.x * CELL_SIZE) + CELL_SIZE/2, 
                     0.5f, 
-                    (ctx->currentPath[i].y * CELL_SIZE) + CELL_SIZE/2 
+                    (cell.y * CELL_SIZE) + CELL_SIZE/2 
                 };
                 
                 DrawLine3D(start, end, RED);
@@ -1340,38 +2746,59 @@
         // Draw UI text at the edges of the grid
         Draw3DHUD(ctx);
 
-        for (int x = 0; x < GRID_WIDTH; x++)
+        // Faint floor grid over the whole arena, one line per row and column of cell edges, so empty
+        // areas look like the rest without the tiles they don't have
+        for (int x = 0; x <= ctx->gridWidth; x++) {
+            DrawLine3D((Vector3){x*CELL_SIZE, -CELL_SIZE/2, 0.0f}, (Vector3){x*CELL_SIZE, -CELL_SIZE/2, ctx->gridHeight*CELL_SIZE}, LIGHTGRAY);
+        }
+        for (int y = 0; y <= ctx->gridHeight; y++) {
+            DrawLine3D((Vector3){0.0f, -CELL_SIZE/2, y*CELL_SIZE}, (Vector3){ctx->gridWidth*CELL_SIZE, -CELL_SIZE/2, y*CELL_SIZE}, LIGHTGRAY);
+        }
+
+        // Walls only exist in populated tiles
+        for (int t = 0; t < ctx->world.populatedCount; t++)
         {
-            for (int y = 0; y < GRID_HEIGHT; y++)
+            const WorldTile *tile = ctx->world.populated[t];
+            int width = min(WORLD_TILE_SIZE, ctx->gridWidth - tile->originX);
+            int height = min(WORLD_TILE_SIZE, ctx->gridHeight - tile->originY);
+            for (int y = 0; y < height; y++)
             {
-                Vector3 cellPos = {
-                    (x * CELL_SIZE) + CELL_SIZE/2, 
-                    0.0f, 
-                    (y * CELL_SIZE) + CELL_SIZE/2
-                };
-
-                if (ctx->grid[x][y] != CELL_AIR)
+                for (int x = 0; x < width; x++)
                 {
-                    DrawCube(cellPos, CELL_SIZE, CELL_SIZE, CELL_SIZE, cellFillColours[ctx->grid[x][y]-1]);
-                    DrawCubeWires(cellPos, CELL_SIZE, CELL_SIZE, CELL_SIZE, cellOutlineColours[ctx->grid[x][y]-1]);
-                }
-                else
-                {
-                    // Draw faint floor outline
-                    cellPos.y = -CELL_SIZE/2;
-                    DrawCubeWires(cellPos, CELL_SIZE, 0.0f, CELL_SIZE, LIGHTGRAY);
+                    // Entities are drawn from their own positions below, so they can move between cells
+                    int cell = tile->cells[y*WORLD_TILE_SIZE + x];
+                    if (cell != CELL_WALL) continue;
+                    Vector3 cellPos = {
+                        ((tile->originX + x) * CELL_SIZE) + CELL_SIZE/2, 
+                        0.0f, 
+                        ((tile->originY + y) * CELL_SIZE) + CELL_SIZE/2
+                    };
+                    DrawCube(cellPos, CELL_SIZE, CELL_SIZE, CELL_SIZE, cellFillColours[cell-1]);
+                    DrawCubeWires(cellPos, CELL_SIZE, CELL_SIZE, CELL_SIZE, cellOutlineColours[cell-1]);
                 }
             }
         }
 
+        // Draw entities
+            for (int i=0; i<ctx->people.count; i++) {
+                if (!EntityIsActive(&ctx->people, i)) continue;
+                DrawEntityCube(GetPoolDrawPosition(&ctx->people, i), CELL_PERSON);
+            }
+            for (int i=0; i<ctx->mines.count; i++) {
+                if (!EntityIsActive(&ctx->mines, i)) continue;
+                DrawEntityCube(GetPoolDrawPosition(&ctx->mines, i), CELL_MINE);
+            }
+            Vector2 robotDrawAt = GetDrawPosition(ctx->robot.position, ctx->robot.previousPosition);
+            DrawEntityCube(robotDrawAt, CELL_ROBOT);
+
         // Draw directional eyes
             // People
-            for (int i=0; i<NUM_PEOPLE; i++) {
-                if (ctx->people[i].position.x == -1) continue;
-                DrawDirectionalEyes(&ctx->people[i]);
+            for (int i=0; i<ctx->people.count; i++) {
+                if (!EntityIsActive(&ctx->people, i)) continue;
+                DrawDirectionalEyes(GetPoolDrawPosition(&ctx->people, i), (Direction)ctx->people.direction[i]);
             }
             // Robot
-            DrawDirectionalEyes((MovingEntity*)&ctx->robot);
+            DrawDirectionalEyes(robotDrawAt, ctx->robot.direction);
 
         // Draw Cursor Highlight
         if (ctx->gridCellFocused.x != -1 && ctx->gridCellFocused.y != -1)
@@ -1392,8 +2819,10 @@
         EndMode3D();
     }
 
-    // Uses Bresenham's Line Algorithm to paint a continuous line of cells
-    void PaintGridLine(GameContext *ctx, int x0, int y0, int x1, int y1, int value) {
+    // Uses Bresenham's Line Algorithm to paint a continuous line of cells. Only air and wall cells
+    // are painted over. Returns true if any cell changed.
+    bool PaintGridLine(GameContext *ctx, int x0, int y0, int x1, int y1, int value) {
+        bool changed = false;
         int dx = abs(x1 - x0);
         int dy = abs(y1 - y0);
         int sx = (x0 < x1) ? 1 : -1;
@@ -1402,9 +2831,10 @@
 
         while (true)
         {
-            if (ctx->grid[x0][y0] <= 1 && x0 >= 0 && x0 < GRID_WIDTH && y0 >= 0 && y0 < GRID_HEIGHT)
+            if (IsInsideGrid(ctx, x0, y0) && GetGridCell(ctx, x0, y0) <= 1 && GetGridCell(ctx, x0, y0) != value)
             {
-                ctx->grid[x0][y0] = value;
+                SetGridCell(ctx, x0, y0, value);
+                changed = true;
             }
 
             if (x0 == x1 && y0 == y1) break;
@@ -1413,15 +2843,179 @@
             if (e2 > -dy) { err -= dy; x0 += sx; }
             if (e2 < dx) { err += dx; y0 += sy; }
         }
+        return changed;
     }
 
-    int min(int a, int b) {
-        return a < b ? a : b;
+    // The bitboard for a cell type, or NULL for types the AI never asks about (air)
+    static Bitboard* GetCellBitboard(GameContext *ctx, int cellType) {
+        switch (cellType) {
+            case CELL_WALL: return &ctx->bitboards.wall;
+            case CELL_MINE: return &ctx->bitboards.mine;
+            case CELL_PERSON: return &ctx->bitboards.person;
+            case CELL_ROBOT: return &ctx->bitboards.robot;
+            default: return NULL;
+        }
     }
 
-    int max(int a, int b) {
-        return a > b ? a : b;
-    }
+    // All gameplay writes to the grid go through here so the AI can see what changed
+    void SetGridCell(GameContext *ctx, int x, int y, int value) {
+        int cell = GetGridCell(ctx, x, y);
+        if (cell == value) return;
+        PutWorldCell(ctx, x, y, value);
+        if (ctx->cellStorage == NULL) return; // The AI hasn't planned yet, and reads the world when it does
+
+        bool wallChanged = cell == CELL_WALL || value == CELL_WALL;
+        if (wallChanged) MarkTileStale(&ctx->router, x, y);
+        // The rest is in window cells, and only matters if the window holds the cell
+        GridPos at = WorldToWindow(ctx, (GridPos){x, y});
+        if (!ctx->window.placed || !IsInsideWindow(ctx, at.x, at.y)) return;
+        x = at.x;
+        y = at.y;
+
+        Bitboard *oldBits = GetCellBitboard(ctx, cell);
+        Bitboard *newBits = GetCellBitboard(ctx, value);
+        if (oldBits != NULL) BitboardReset(oldBits, x, y);
+        if (newBits != NULL) BitboardSet(newBits, x, y);
+        if (wallChanged) {
+            ctx->jps.tablesStale = true;
+            ctx->rescuePlan.stale = true;
+            MarkClustersStale(ctx, x, y);
+        }
+        if (cell == CELL_MINE || value == CELL_MINE) ctx->jps.hazardsStale = true;
+
+        DirtyCells *dirty = &ctx->dirtyCells;
+        if (dirty->count < MAX_DIRTY_CELLS) {
+            dirty->x[dirty->count] = x;
+            dirty->y[dirty->count] = y;
+            dirty->count++;
+        } else {
+            dirty->overflowed = true;
+        }
+    }
+
+    // Writes the world without telling the AI, for bulk edits that finish with MarkAllCellsDirty
+    void PutWorldCell(GameContext *ctx, int x, int y, int value) {
+        if (!WorldSet(&ctx->world, x, y, value)) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // For bulk edits (level setup) where listing every cell is pointless. Those write the world
+    // directly, so the window is reloaded from it and every tile's regions are recounted.
+    void MarkAllCellsDirty(GameContext *ctx) {
+        if (ctx->cellStorage == NULL) return;
+        MarkAllTilesStale(&ctx->router);
+        if (ctx->window.placed) LoadAiWindow(ctx);
+    }
+
+    // Whether the rest of last tick's path (still in ctx->currentPath, previousPathLen long) can be
+    // followed without searching, counting a hit or miss. It can if the robot took the step it was
+    // given, the planner and target are the same, and no cell written since the last tick lies on the
+    // path or puts a mine beside it. D* Lite and the space-time planner keep their own state between
+    // ticks, as does budgeted A*, so they always plan.
+    bool CheckPathCache(GameContext *ctx, int previousPathLen, int startX, int startY, int targetX, int targetY) {
+        PathCache *cache = &ctx->pathCache;
+        if (!ctx->pathCacheEnabled || ctx->planner == PLANNER_DSTAR_LITE || ctx->planner == PLANNER_SPACETIME
+            || (ctx->planner == PLANNER_ASTAR && ctx->searchBudgetEnabled)) {
+            return false;
+        }
+
+        bool valid = cache->valid && cache->planner == (int)ctx->planner && previousPathLen >= 2
+            && ctx->currentPath[previousPathLen - 1].x == startX && ctx->currentPath[previousPathLen - 1].y == startY
+            && !ctx->dirtyCells.overflowed;
+        // The flow field heads for whoever is nearest by path rather than the picked target, so
+        // for it the path only needs to still end on a person
+        if (valid && ctx->planner == PLANNER_FLOW_FIELD) {
+            GridPos end = WindowToWorld(ctx, ctx->currentPath[0]);
+            valid = GetGridCell(ctx, end.x, end.y) == CELL_PERSON;
+        } else if (valid) {
+            valid = cache->targetX == targetX && cache->targetY == targetY;
+        }
+
+        // The robot's own cell (the last entry) is already behind it
+        for (int i = 0; i < ctx->dirtyCells.count && valid; i++) {
+            int dirtyX = ctx->dirtyCells.x[i];
+            int dirtyY = ctx->dirtyCells.y[i];
+            bool mine = IsMineCell(ctx, dirtyX, dirtyY);
+            for (int step = 0; step < previousPathLen - 1; step++) {
+                int dx = abs(ctx->currentPath[step].x - dirtyX);
+                int dy = abs(ctx->currentPath[step].y - dirtyY);
+                if ((dx == 0 && dy == 0) || (mine && dx <= 1 && dy <= 1)) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+
+        if (valid) cache->hits++;
+        else cache->misses++;
+        return valid;
+    }
+
+    // Returns false if malloc() fails
+    bool InitGridBitboards(GridBitboards *boards, int width, int height) {
+        bool ok = InitBitboard(&boards->wall, width, height)
+            && InitBitboard(&boards->mine, width, height)
+            && InitBitboard(&boards->person, width, height)
+            && InitBitboard(&boards->robot, width, height);
+        for (int k = 0; k <= MINE_SAFETY_RADIUS && ok; k++) ok = InitBitboard(&boards->mineChebyshev[k], width, height);
+        for (int k = 0; k <= 2 * MINE_SAFETY_RADIUS && ok; k++) ok = InitBitboard(&boards->mineManhattan[k], width, height);
+        return ok;
+    }
+
+    void FreeGridBitboards(GridBitboards *boards) {
+        FreeBitboard(&boards->wall);
+        FreeBitboard(&boards->mine);
+        FreeBitboard(&boards->person);
+        FreeBitboard(&boards->robot);
+        for (int k = 0; k <= MINE_SAFETY_RADIUS; k++) FreeBitboard(&boards->mineChebyshev[k]);
+        for (int k = 0; k <= 2 * MINE_SAFETY_RADIUS; k++) FreeBitboard(&boards->mineManhattan[k]);
+    }
+
+    // Mines move every frame, so the AI re-runs the distance kernel before it plans
+    void RefreshMineDanger(GameContext *ctx) {
+        BitboardDistanceLevels(&ctx->bitboards.mine, ctx->bitboards.mineChebyshev, MINE_SAFETY_RADIUS + 1, true);
+        BitboardDistanceLevels(&ctx->bitboards.mine, ctx->bitboards.mineManhattan, 2 * MINE_SAFETY_RADIUS + 1, false);
+    }
+
+    // True if (x, y) is a mine or one of the 8 cells around it is
+    bool IsNearMine(GameContext *ctx, int x, int y) {
+        return BitboardTest(&ctx->bitboards.mineChebyshev[1], x, y);
+    }
+
+    // Manhattan distance to the closest mine, or 999 if none lies within MINE_SAFETY_RADIUS of (x, y)
+    // in both axes. Higher is safer. A mine inside that window is at most 2 * radius edge steps away,
+    // so the Manhattan levels always reach it.
+    int GetMineSafetyScore(GameContext *ctx, int x, int y) {
+        if (!BitboardTest(&ctx->bitboards.mineChebyshev[MINE_SAFETY_RADIUS], x, y)) return 999;
+        int distance = 0;
+        while (!BitboardTest(&ctx->bitboards.mineManhattan[distance], x, y)) distance++;
+        return distance;
+    }
+
+    // Bit d set if the neighbour in DIR_VECTORS[d] is a wall, a mine, the respawn point or off the grid
+    int GetBlockedNeighbours(GameContext *ctx, int x, int y) {
+        int blocked = BitboardNeighbourMask(&ctx->bitboards.wall, &ctx->bitboards.mine, x, y);
+        GridPos spawn = WorldToWindow(ctx, GetRobotSpawn(ctx));
+        for (int i = 0; i < 4; i++) {
+            if (x + DIR_VECTORS[i].x == spawn.x && y + DIR_VECTORS[i].y == spawn.y) blocked |= 1 << i;
+        }
+        return blocked;
+    }
+
+    int min(int a, int b) {
+        return a < b ? a : b;
+    }
+
+    // Simple Manhattan Distance Heuristic
+    int GetDistance(int x1, int y1, int x2, int y2) {
+        return abs(x1 - x2) + abs(y1 - y2);
+    }
+
+    int max(int a, int b) {
+        return a > b ? a : b;
+    }
 
     int CompareScores(const void *a, const void *b) {
         ScoreEntry *entryA = (ScoreEntry *)a;
@@ -1435,6 +3029,85 @@
         return entryA->duration - entryB->duration;
     }
 
+    void RecordUpdateTime(GameContext *ctx, float milliseconds) {
+        ctx->updateTimes[ctx->updateTimeNext] = milliseconds;
+        ctx->updateTimeNext = (ctx->updateTimeNext + 1) % FRAME_TIME_SAMPLES;
+        if (ctx->updateTimeCount < FRAME_TIME_SAMPLES) ctx->updateTimeCount++;
+    }
+
+    static int CompareFloats(const void *a, const void *b) {
+        float fa = *(const float *)a;
+        float fb = *(const float *)b;
+        return (fa > fb) - (fa < fb);
+    }
+
+    // Nearest-rank percentile (0..1) of the recorded gameplay update times, in ms
+    float GetUpdateTimePercentile(GameContext *ctx, float percentile) {
+        if (ctx->updateTimeCount == 0) return 0.0f;
+        float sorted[FRAME_TIME_SAMPLES];
+        memcpy(sorted, ctx->updateTimes, sizeof(float) * ctx->updateTimeCount);
+        qsort(sorted, ctx->updateTimeCount, sizeof(float), CompareFloats);
+        int rank = (int)(percentile * ctx->updateTimeCount + 0.999f) - 1;
+        return sorted[max(0, min(rank, ctx->updateTimeCount - 1))];
+    }
+
+    void SeedGameRandom(GameRandom *rng, uint64_t seed, uint64_t stream) {
+        rng->state = 0;
+        rng->increment = (stream << 1) | 1;
+        NextGameRandom(rng);
+        rng->state += seed;
+        NextGameRandom(rng);
+    }
+
+    // Streams keyed on --seed and the level, so a level's layout and motion never depend on
+    // what was drawn before it, or on which thread generates it
+    void SeedLevelRandom(GameContext *ctx, GameRandom *rng, uint64_t stream) {
+        SeedGameRandom(rng, ((uint64_t)ctx->seed << 32) | (uint32_t)ctx->currentLevel, stream);
+    }
+
+    uint32_t NextGameRandom(GameRandom *rng) {
+        uint64_t old = rng->state;
+        rng->state = old * 6364136223846793005ULL + rng->increment;
+        uint32_t xorShifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = (uint32_t)(old >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    // 0 .. bound-1, by multiply-shift rather than %, which is slower and skews towards low values
+    uint32_t NextGameRandomBelow(GameRandom *rng, uint32_t bound) {
+        return (uint32_t)(((uint64_t)NextGameRandom(rng) * bound) >> 32);
+    }
+
+    // [0, 1) with 24 bits, every value exactly representable as a float
+    float NextGameRandomFloat(GameRandom *rng) {
+        return (NextGameRandom(rng) >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Seconds on a monotonic clock. Unlike raylib's GetTime() it needs no window.
+    double GetMonotonicTime(void) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (double)now.tv_sec + now.tv_nsec / 1e9;
+    }
+
+    // Whether a search started at start (GetMonotonicTime) has spent budget seconds. Games go by
+    // the clock whether or not they are recorded, and the recording notes each check that ran out.
+    // A replay runs out at exactly those checks, whatever its own clock says.
+    bool SearchBudgetSpent(GameContext *ctx, double start, double budget) {
+        ctx->budgetChecks++;
+        ReplayBudgets *replay = &ctx->replayBudgets;
+        if (replay->active) {
+            if (replay->count == 0 || replay->spentAt[0] != ctx->budgetChecks) return false;
+            replay->count--;
+            memmove(replay->spentAt, replay->spentAt + 1, sizeof(uint64_t) * replay->count);
+            return true;
+        }
+        if (GetMonotonicTime() - start < budget) return false;
+        if (ctx->recorder.file != NULL) WriteReplayBudgetSpent(ctx);
+        return true;
+    }
+
+
     Direction GetCameraForwardDirection(Camera3D camera) {
         Vector3 forward = Vector3Subtract(camera.target, camera.position);
         
@@ -1445,4 +3118,2006 @@
             return (forward.x > 0) ? EAST : WEST;
         }
     }
-    
\ No newline at end of file
+    
+
+//--------------------------------------------------------------------------------------
+// Pathfinding Helpers
+//--------------------------------------------------------------------------------------
+    // Heap ordering: lowest fCost first, ties go to the node closest to the target
+    static bool NodeIsCheaper(Node *a, Node *b) {
+        if (a->fCost != b->fCost) return a->fCost < b->fCost;
+        return a->hCost < b->hCost;
+    }
+
+    static void OpenSetSwap(OpenSet *set, int i, int j) {
+        Node *tmp = set->items[i];
+        set->items[i] = set->items[j];
+        set->items[j] = tmp;
+        set->items[i]->heapIndex = i;
+        set->items[j]->heapIndex = j;
+    }
+
+    static void OpenSetSiftUp(OpenSet *set, int i) {
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!NodeIsCheaper(set->items[i], set->items[parent])) break;
+            OpenSetSwap(set, i, parent);
+            i = parent;
+        }
+    }
+
+    static void OpenSetSiftDown(OpenSet *set, int i) {
+        while (true) {
+            int left = 2*i + 1;
+            int right = left + 1;
+            int smallest = i;
+            if (left < set->count && NodeIsCheaper(set->items[left], set->items[smallest])) smallest = left;
+            if (right < set->count && NodeIsCheaper(set->items[right], set->items[smallest])) smallest = right;
+            if (smallest == i) break;
+            OpenSetSwap(set, i, smallest);
+            i = smallest;
+        }
+    }
+
+    // Returns false if malloc() fails
+    bool InitOpenSet(OpenSet *set, int capacity) {
+        set->items = malloc(sizeof(Node*) * capacity);
+        set->count = 0;
+        set->capacity = capacity;
+        return set->items != NULL;
+    }
+
+    void OpenSetPush(OpenSet *set, Node *node) {
+        node->heapIndex = set->count;
+        set->items[set->count] = node;
+        set->count++;
+        OpenSetSiftUp(set, node->heapIndex);
+    }
+
+    // Removes and returns the cheapest node, or NULL if the set is empty
+    Node* OpenSetPop(OpenSet *set) {
+        if (set->count == 0) return NULL;
+        Node *top = set->items[0];
+        set->count--;
+        if (set->count > 0) {
+            set->items[0] = set->items[set->count];
+            set->items[0]->heapIndex = 0;
+            OpenSetSiftDown(set, 0);
+        }
+        top->heapIndex = -1;
+        return top;
+    }
+
+    // Call after lowering a queued node's fCost
+    void OpenSetDecreaseKey(OpenSet *set, Node *node) {
+        OpenSetSiftUp(set, node->heapIndex);
+    }
+
+    // Call after changing a queued node's key in either direction
+    void OpenSetUpdate(OpenSet *set, Node *node) {
+        OpenSetSiftUp(set, node->heapIndex);
+        OpenSetSiftDown(set, node->heapIndex);
+    }
+
+    void OpenSetRemove(OpenSet *set, Node *node) {
+        int i = node->heapIndex;
+        set->count--;
+        if (i != set->count) {
+            set->items[i] = set->items[set->count];
+            set->items[i]->heapIndex = i;
+            OpenSetUpdate(set, set->items[i]);
+        }
+        node->heapIndex = -1;
+    }
+
+    // Starts a new search: empties the open set and invalidates every node in O(1)
+    void BeginSearch(SearchWorkspace *ws) {
+        ws->openSet.count = 0;
+        ws->searchActive = false;
+        ws->generation++;
+        // On wrap-around, stale stamps could collide with the new generation, so clear them once
+        if (ws->generation == 0) {
+            for (int i = 0; i < ws->width * ws->height; i++) ws->nodes[i].generation = 0;
+            ws->generation = 1;
+        }
+    }
+
+    // Step cost A* charges for moving into (x, y): blocked by walls, mines and the respawn point, and
+    // 20 extra next to a mine. Needs the mine distance bitboards to be up to date (RefreshMineDanger).
+    int GetEnterCost(GameContext *ctx, int x, int y) {
+        if (BitboardTest(&ctx->bitboards.wall, x, y) || BitboardTest(&ctx->bitboards.mine, x, y)
+            || IsRobotSpawn(ctx, x, y)) return PATH_COST_INFINITY;
+        return 1 + (IsNearMine(ctx, x, y) ? 20 : 0);
+    }
+
+    // Returns the node at (x, y), resetting it first if this search hasn't touched it yet
+    Node* GetSearchNode(SearchWorkspace *ws, int x, int y) {
+        Node *node = &ws->nodes[CellIndex(ws->width, x, y)];
+        if (node->generation != ws->generation) {
+            *node = (Node){x, y, 9999, 9999, 9999, -1, -1, false, false, -1, ws->generation};
+        }
+        return node;
+    }
+
+    // Breadth-first search out from a source through everything but walls. Unreached cells are
+    // PATH_COST_INFINITY. distance and frontier both need room for every window cell, indexed by CellIndex.
+    void BuildStepDistance(GameContext *ctx, int *distance, int *frontier, int sourceX, int sourceY) {
+        int width = ctx->window.width;
+        for (int i = 0; i < ctx->window.cellCount; i++) distance[i] = PATH_COST_INFINITY;
+        int head = 0, tail = 0;
+        distance[CellIndex(width, sourceX, sourceY)] = 0;
+        frontier[tail++] = CellIndex(width, sourceX, sourceY);
+        while (head < tail) {
+            int cell = frontier[head++];
+            int x = cell % width;
+            int y = cell / width;
+            for (int i = 0; i < 4; i++) {
+                int nx = x + DIR_VECTORS[i].x;
+                int ny = y + DIR_VECTORS[i].y;
+                if (!IsInsideWindow(ctx, nx, ny)) continue;
+                int next = CellIndex(width, nx, ny);
+                if (BitboardTest(&ctx->bitboards.wall, nx, ny) || distance[next] != PATH_COST_INFINITY) continue;
+                distance[next] = distance[cell] + 1;
+                frontier[tail++] = next;
+            }
+        }
+    }
+
+//--------------------------------------------------------------------------------------
+// Path Planners
+// Each planner writes ctx->currentPath (target first, next step last) and
+// ctx->searchNodesExpanded. currentPathLen stays 0 when the target is unreachable.
+//--------------------------------------------------------------------------------------
+    // Weighted A*, searched from scratch every call
+    void PlanPathAStar(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        BeginAStar(ctx, startX, startY, targetX, targetY);
+        ContinueAStar(ctx, 0, 0.0);
+        TraceAStarPath(ctx, startX, startY);
+        ctx->searchWorkspace.searchActive = false;
+    }
+
+    // Starts an A* query that ContinueAStar can then run in as many slices as it likes
+    void BeginAStar(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        // INITIALIZE A* DATA
+        // Nodes are reset lazily by GetSearchNode, so this costs nothing per grid cell
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        BeginSearch(ws);
+        ctx->searchNodesExpanded = 0;
+        ws->searchActive = true;
+        ws->searchFinished = false;
+        ws->startX = startX;
+        ws->startY = startY;
+        ws->targetX = targetX;
+        ws->targetY = targetY;
+        ws->goalNode = NULL;
+
+        Node *startNode = GetSearchNode(ws, startX, startY);
+        startNode->gCost = 0;
+        startNode->hCost = GetDistance(startX, startY, targetX, targetY);
+        startNode->fCost = startNode->hCost;
+        startNode->open = true;
+        OpenSetPush(&ws->openSet, startNode);
+        ws->bestNode = startNode;
+    }
+
+    // Expands up to nodeBudget nodes or timeBudget seconds (0 for no limit on either).
+    // Returns true once the search is over, whether or not the target was reached.
+    bool ContinueAStar(GameContext *ctx, int nodeBudget, double timeBudget) {
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        int targetX = ws->targetX;
+        int targetY = ws->targetY;
+        double sliceStart = timeBudget > 0.0 ? GetMonotonicTime() : 0.0;
+
+        // MAIN A* LOOP
+        for (int expanded = 0; !ws->searchFinished; expanded++) {
+            if (nodeBudget > 0 && expanded >= nodeBudget) break;
+            // Reading the clock costs more than an expansion, so only look every few nodes
+            if (timeBudget > 0.0 && (expanded & 15) == 15 && SearchBudgetSpent(ctx, sliceStart, timeBudget)) break;
+
+            // Cheapest open node sits at the root of the heap: O(log n) instead of a full grid scan
+            Node* current = OpenSetPop(&ws->openSet);
+
+            // FIX 1: If no path found, BREAK (don't return) so we can run the fallback logic
+            if (current == NULL) {
+                ws->searchFinished = true;
+                break;
+            }
+            ctx->searchNodesExpanded++;
+
+            if (current->x == targetX && current->y == targetY) {
+                ws->goalNode = current;
+                ws->searchFinished = true;
+                break;
+            }
+
+            current->open = false;
+            current->closed = true;
+            if (current->hCost < ws->bestNode->hCost) ws->bestNode = current;
+
+            int dirX[] = {0, 1, 0, -1};
+            int dirY[] = {-1, 0, 1, 0};
+            // Bounds, walls and mines for all four neighbours in one go
+            int blocked = GetBlockedNeighbours(ctx, current->x, current->y);
+
+            for (int i = 0; i < 4; i++) {
+                if (blocked & (1 << i)) continue;
+                int checkX = current->x + dirX[i];
+                int checkY = current->y + dirY[i];
+
+                Node *neighbour = GetSearchNode(ws, checkX, checkY);
+                if (neighbour->closed) continue;
+
+                // FIX 2: Soft Penalty instead of Hard Wall
+                // If tile is near a mine, add 20 to the cost (robot will detour if possible)
+                // But it WILL go there if it's the only path.
+                int dangerPenalty = 0;
+                if (IsNearMine(ctx, checkX, checkY)) dangerPenalty = 20;
+
+                int moveCost = current->gCost + 1 + dangerPenalty;
+
+                if (moveCost < neighbour->gCost || !neighbour->open) {
+                    neighbour->gCost = moveCost;
+                    // Ensure you have this multiplier variable in your struct, or use 1.5f directly
+                    neighbour->hCost = (int)(GetDistance(checkX, checkY, targetX, targetY) * ctx->AStarHeuristicWeightage); 
+                    neighbour->fCost = neighbour->gCost + neighbour->hCost;
+                    neighbour->parentX = current->x;
+                    neighbour->parentY = current->y;
+                    // Already queued means its fCost just dropped, so sift it up rather than push a duplicate
+                    if (neighbour->open) OpenSetDecreaseKey(&ws->openSet, neighbour);
+                    else OpenSetPush(&ws->openSet, neighbour);
+                    neighbour->open = true;
+                }
+            }
+        }
+        return ws->searchFinished;
+    }
+
+    // Node the current path ends at: the target if the search reached it, the most promising node if
+    // it is still running, and NULL if it finished without reaching the target
+    static Node* GetAStarPathEnd(SearchWorkspace *ws) {
+        return ws->goalNode != NULL ? ws->goalNode : (ws->searchFinished ? NULL : ws->bestNode);
+    }
+
+    // Whether (x, y) lies on the current path
+    static bool AStarPathPasses(SearchWorkspace *ws, int x, int y) {
+        Node *endNode = GetAStarPathEnd(ws);
+        if (endNode == NULL) return false;
+        int traceX = endNode->x;
+        int traceY = endNode->y;
+        while (traceX != -1) {
+            if (traceX == x && traceY == y) return true;
+            Node *node = &ws->nodes[CellIndex(ws->width, traceX, traceY)];
+            traceX = node->parentX;
+            traceY = node->parentY;
+        }
+        return false;
+    }
+
+    // Writes the current path from (fromX, fromY), which is the search's start unless the robot
+    // has since stepped along the path
+    void TraceAStarPath(GameContext *ctx, int fromX, int fromY) {
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        Node *endNode = GetAStarPathEnd(ws);
+        if (endNode == NULL) return;
+
+        // Retrace path
+        int traceX = endNode->x;
+        int traceY = endNode->y;
+        while (traceX != -1 && traceY != -1) {
+            if (traceX == fromX && traceY == fromY) break;
+            ctx->currentPath[ctx->currentPathLen] = (GridPos){traceX, traceY};
+            ctx->currentPathLen++;
+            // Everything on the parent chain was touched this search, so read it directly
+            Node *node = &ws->nodes[CellIndex(ws->width, traceX, traceY)];
+            traceX = node->parentX;
+            traceY = node->parentY;
+        }
+    }
+
+    // One frame's worth of the budgeted A*. Picks up where the last frame left off unless the target
+    // has moved or the robot has left the partial path. Stepping along that path keeps the search
+    // useful, since the rest of the path still starts where the robot now is.
+    void AdvanceBudgetedAStar(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        bool restart = !ws->searchActive || ws->targetX != targetX || ws->targetY != targetY;
+        if (!restart && (ws->startX != startX || ws->startY != startY)) restart = !AStarPathPasses(ws, startX, startY);
+        if (restart) {
+            // Mines have moved since the last tick, so costs would be stale for the whole search
+            RefreshMineDanger(ctx);
+            BeginAStar(ctx, startX, startY, targetX, targetY);
+        }
+        if (!ws->searchFinished) ContinueAStar(ctx, ctx->searchNodeBudget, ctx->searchTimeBudgetUs / 1000000.0);
+    }
+
+    // Touches a node for ARA*, which needs a real infinity (9999 is a reachable cost) and keeps the
+    // unweighted heuristic in hCost so the weight can change between passes
+    static Node* GetAnytimeNode(SearchWorkspace *ws, int x, int y, int targetX, int targetY) {
+        bool fresh = ws->nodes[CellIndex(ws->width, x, y)].generation != ws->generation;
+        Node *node = GetSearchNode(ws, x, y);
+        if (fresh) {
+            node->gCost = PATH_COST_INFINITY;
+            node->hCost = GetDistance(x, y, targetX, targetY);
+        }
+        return node;
+    }
+
+    // One ARA* pass: expands until nothing open could beat the target's cost under this weight.
+    // Returns false if ARA_TIME_BUDGET ran out first, counted from budgetStart (0 for no limit).
+    static bool AnytimeImprovePath(GameContext *ctx, Node *goal, float weight, double budgetStart) {
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        AnytimeSearch *ara = &ctx->ara;
+
+        for (int expanded = 0; ws->openSet.count > 0; expanded++) {
+            if (goal->gCost <= ws->openSet.items[0]->fCost) break;
+            if (budgetStart > 0.0 && (expanded & 15) == 15 && SearchBudgetSpent(ctx, budgetStart, ARA_TIME_BUDGET)) return false;
+
+            Node *current = OpenSetPop(&ws->openSet);
+            current->open = false;
+            current->closed = true;
+            ara->closedNodes[ara->closedCount++] = current;
+            ctx->searchNodesExpanded++;
+
+            int blocked = GetBlockedNeighbours(ctx, current->x, current->y);
+            for (int i = 0; i < 4; i++) {
+                // Same costs as A*: no walls or mines, and a detour premium next to a mine
+                if (blocked & (1 << i)) continue;
+                int checkX = current->x + DIR_VECTORS[i].x;
+                int checkY = current->y + DIR_VECTORS[i].y;
+                int moveCost = current->gCost + 1 + (IsNearMine(ctx, checkX, checkY) ? 20 : 0);
+
+                Node *neighbour = GetAnytimeNode(ws, checkX, checkY, goal->x, goal->y);
+                if (moveCost >= neighbour->gCost) continue;
+                neighbour->gCost = moveCost;
+                neighbour->parentX = current->x;
+                neighbour->parentY = current->y;
+
+                if (!neighbour->closed) {
+                    neighbour->fCost = neighbour->gCost + (int)(weight * neighbour->hCost);
+                    if (neighbour->open) OpenSetDecreaseKey(&ws->openSet, neighbour);
+                    else OpenSetPush(&ws->openSet, neighbour);
+                    neighbour->open = true;
+                }
+                // Closed this pass already: re-expanding now would break the pass's bound, so hold it back
+                else if (!ara->inconsistent[CellIndex(ws->width, checkX, checkY)]) {
+                    ara->inconsistent[CellIndex(ws->width, checkX, checkY)] = true;
+                    ara->inconsistentNodes[ara->inconsistentCount++] = neighbour;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Anytime Repairing A* (Likhachev et al.). The first pass runs to completion at the player's
+    // heuristic weight, so there is always a path. Later passes lower the weight towards 1.0, reusing
+    // the open list and the costs found so far, until ARA_TIME_BUDGET runs out. Each finished pass
+    // replaces ctx->currentPath and records the bound it proved.
+    void PlanPathARA(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        AnytimeSearch *ara = &ctx->ara;
+        BeginSearch(ws);
+        // Only the last search's held-back nodes can still be flagged
+        for (int i = 0; i < ara->inconsistentCount; i++) {
+            Node *node = ara->inconsistentNodes[i];
+            ara->inconsistent[CellIndex(ws->width, node->x, node->y)] = false;
+        }
+        ara->inconsistentCount = 0;
+        ara->closedCount = 0;
+        ara->boundReached = 0.0f;
+        ctx->searchNodesExpanded = 0;
+
+        float weight = ctx->AStarHeuristicWeightage > 1.0f ? ctx->AStarHeuristicWeightage : 1.0f;
+        Node *goal = GetAnytimeNode(ws, targetX, targetY, targetX, targetY);
+        Node *startNode = GetAnytimeNode(ws, startX, startY, targetX, targetY);
+        startNode->gCost = 0;
+        startNode->fCost = (int)(weight * startNode->hCost);
+        startNode->open = true;
+        OpenSetPush(&ws->openSet, startNode);
+
+        double budgetStart = 0.0;
+        while (AnytimeImprovePath(ctx, goal, weight, budgetStart)) {
+            if (goal->gCost >= PATH_COST_INFINITY) break; // Unreachable, a lower weight won't change that
+
+            ctx->currentPathLen = 0;
+            for (Node *node = goal; node != startNode; node = &ws->nodes[CellIndex(ws->width, node->parentX, node->parentY)]) {
+                ctx->currentPath[ctx->currentPathLen++] = (GridPos){node->x, node->y};
+            }
+
+            // Anything cheaper than the path would have to pass through an open or held-back node
+            int lowerBound = goal->gCost;
+            for (int i = 0; i < ws->openSet.count; i++) {
+                lowerBound = min(lowerBound, ws->openSet.items[i]->gCost + ws->openSet.items[i]->hCost);
+            }
+            for (int i = 0; i < ara->inconsistentCount; i++) {
+                lowerBound = min(lowerBound, ara->inconsistentNodes[i]->gCost + ara->inconsistentNodes[i]->hCost);
+            }
+            float bound = lowerBound > 0 ? (float)goal->gCost / lowerBound : 1.0f;
+            ara->boundReached = bound < weight ? bound : weight;
+            if (ara->boundReached <= 1.0f) break;
+
+            // Next pass: lower the weight, put held-back nodes back in play and re-key the open list
+            weight = weight - ARA_WEIGHT_STEP > 1.0f ? weight - ARA_WEIGHT_STEP : 1.0f;
+            for (int i = 0; i < ara->inconsistentCount; i++) {
+                Node *node = ara->inconsistentNodes[i];
+                ara->inconsistent[CellIndex(ws->width, node->x, node->y)] = false;
+                node->open = true;
+                ws->openSet.items[ws->openSet.count++] = node;
+            }
+            ara->inconsistentCount = 0;
+            int openCount = ws->openSet.count;
+            ws->openSet.count = 0;
+            for (int i = 0; i < openCount; i++) {
+                Node *node = ws->openSet.items[i];
+                node->fCost = node->gCost + (int)(weight * node->hCost);
+                OpenSetPush(&ws->openSet, node);
+            }
+            for (int i = 0; i < ara->closedCount; i++) ara->closedNodes[i]->closed = false;
+            ara->closedCount = 0;
+            if (budgetStart == 0.0) budgetStart = GetMonotonicTime();
+        }
+    }
+
+    // Adds two path costs, keeping PATH_COST_INFINITY sticky
+    static int AddPathCost(int a, int b) {
+        if (a >= PATH_COST_INFINITY || b >= PATH_COST_INFINITY) return PATH_COST_INFINITY;
+        return a + b;
+    }
+
+    // D* Lite priority of (x, y): key1 = min(g, rhs) + h + km, key2 = min(g, rhs).
+    // Queued nodes store it as fCost/hCost, which is exactly the order NodeIsCheaper sorts by.
+    static void DStarCalculateKey(DStarLite *ds, int x, int y, int *key1, int *key2) {
+        int best = min(ds->nodes[CellIndex(ds->width, x, y)].gCost, ds->rhs[CellIndex(ds->width, x, y)]);
+        *key2 = best;
+        *key1 = AddPathCost(best, GetDistance(ds->startX, ds->startY, x, y) + ds->keyModifier);
+    }
+
+    // rhs is the cheapest "step into a neighbour, then follow its g" option
+    static int DStarLookahead(DStarLite *ds, int x, int y) {
+        if (x == ds->goalX && y == ds->goalY) return 0;
+        int best = PATH_COST_INFINITY;
+        for (int i = 0; i < 4; i++) {
+            int nx = x + DIR_VECTORS[i].x;
+            int ny = y + DIR_VECTORS[i].y;
+            if (nx < 0 || nx >= ds->width || ny < 0 || ny >= ds->height) continue;
+            best = min(best, AddPathCost(ds->cost[CellIndex(ds->width, nx, ny)], ds->nodes[CellIndex(ds->width, nx, ny)].gCost));
+        }
+        return best;
+    }
+
+    // Queues (x, y) if it is inconsistent (g != rhs), otherwise takes it out of the queue
+    static void DStarUpdateVertex(DStarLite *ds, int x, int y) {
+        Node *node = &ds->nodes[CellIndex(ds->width, x, y)];
+        bool queued = node->heapIndex != -1;
+        if (node->gCost != ds->rhs[CellIndex(ds->width, x, y)]) {
+            DStarCalculateKey(ds, x, y, &node->fCost, &node->hCost);
+            if (queued) OpenSetUpdate(&ds->queue, node);
+            else OpenSetPush(&ds->queue, node);
+        } else if (queued) {
+            OpenSetRemove(&ds->queue, node);
+        }
+    }
+
+    static void DStarReset(GameContext *ctx, DStarLite *ds, int startX, int startY, int goalX, int goalY) {
+        ds->queue.count = 0;
+        ds->startX = startX;
+        ds->startY = startY;
+        ds->goalX = goalX;
+        ds->goalY = goalY;
+        ds->keyModifier = 0;
+        for (int y = 0; y < ds->height; y++) {
+            for (int x = 0; x < ds->width; x++) {
+                int i = CellIndex(ds->width, x, y);
+                ds->nodes[i] = (Node){x, y, PATH_COST_INFINITY, 0, 0, -1, -1, false, false, -1, 0};
+                ds->rhs[i] = PATH_COST_INFINITY;
+                ds->cost[i] = GetEnterCost(ctx, x, y);
+            }
+        }
+        ds->rhs[CellIndex(ds->width, goalX, goalY)] = 0;
+        DStarUpdateVertex(ds, goalX, goalY);
+        ds->initialised = true;
+    }
+
+    // Entering (x, y) now costs newCost. Every neighbour that can step into it may have a new rhs.
+    static void DStarApplyCostChange(DStarLite *ds, int x, int y, int newCost) {
+        int i = CellIndex(ds->width, x, y);
+        int oldCost = ds->cost[i];
+        ds->cost[i] = newCost;
+        int g = ds->nodes[i].gCost;
+
+        for (int d = 0; d < 4; d++) {
+            int ux = x + DIR_VECTORS[d].x;
+            int uy = y + DIR_VECTORS[d].y;
+            if (ux < 0 || ux >= ds->width || uy < 0 || uy >= ds->height) continue;
+            if (ux == ds->goalX && uy == ds->goalY) continue;
+
+            int *rhs = &ds->rhs[CellIndex(ds->width, ux, uy)];
+            if (newCost < oldCost) {
+                *rhs = min(*rhs, AddPathCost(newCost, g));
+            } else if (*rhs == AddPathCost(oldCost, g)) {
+                // The edge that got dearer was this neighbour's best option, so look again
+                *rhs = DStarLookahead(ds, ux, uy);
+            }
+            DStarUpdateVertex(ds, ux, uy);
+        }
+    }
+
+    static bool DStarKeyLess(int a1, int a2, int b1, int b2) {
+        if (a1 != b1) return a1 < b1;
+        return a2 < b2;
+    }
+
+    // Settles inconsistent cells until the robot's cell has its final cost
+    static void DStarComputeShortestPath(GameContext *ctx, DStarLite *ds) {
+        Node *start = &ds->nodes[CellIndex(ds->width, ds->startX, ds->startY)];
+        while (ds->queue.count > 0) {
+            int startKey1, startKey2;
+            DStarCalculateKey(ds, ds->startX, ds->startY, &startKey1, &startKey2);
+            Node *top = ds->queue.items[0];
+            if (!DStarKeyLess(top->fCost, top->hCost, startKey1, startKey2)
+                && ds->rhs[CellIndex(ds->width, ds->startX, ds->startY)] <= start->gCost) break;
+
+            int x = top->x;
+            int y = top->y;
+            int newKey1, newKey2;
+            DStarCalculateKey(ds, x, y, &newKey1, &newKey2);
+            ctx->searchNodesExpanded++;
+
+            if (DStarKeyLess(top->fCost, top->hCost, newKey1, newKey2)) {
+                // Key is stale (the robot has moved since it was queued): requeue with the fresh one
+                top->fCost = newKey1;
+                top->hCost = newKey2;
+                OpenSetUpdate(&ds->queue, top);
+            } else if (top->gCost > ds->rhs[CellIndex(ds->width, x, y)]) {
+                // Overconsistent: a cheaper route was found, lock it in and pass it on
+                top->gCost = ds->rhs[CellIndex(ds->width, x, y)];
+                OpenSetRemove(&ds->queue, top);
+                int viaCost = AddPathCost(ds->cost[CellIndex(ds->width, x, y)], top->gCost);
+                for (int i = 0; i < 4; i++) {
+                    int ux = x + DIR_VECTORS[i].x;
+                    int uy = y + DIR_VECTORS[i].y;
+                    if (ux < 0 || ux >= ds->width || uy < 0 || uy >= ds->height) continue;
+                    if (ux == ds->goalX && uy == ds->goalY) continue;
+                    int *rhs = &ds->rhs[CellIndex(ds->width, ux, uy)];
+                    *rhs = min(*rhs, viaCost);
+                    DStarUpdateVertex(ds, ux, uy);
+                }
+            } else {
+                // Underconsistent: the old route got dearer, so anything that relied on it must look again
+                int oldViaCost = AddPathCost(ds->cost[CellIndex(ds->width, x, y)], top->gCost);
+                top->gCost = PATH_COST_INFINITY;
+                for (int i = 0; i < 4; i++) {
+                    int ux = x + DIR_VECTORS[i].x;
+                    int uy = y + DIR_VECTORS[i].y;
+                    if (ux < 0 || ux >= ds->width || uy < 0 || uy >= ds->height) continue;
+                    if (ux == ds->goalX && uy == ds->goalY) continue;
+                    int *rhs = &ds->rhs[CellIndex(ds->width, ux, uy)];
+                    if (*rhs == oldViaCost) *rhs = DStarLookahead(ds, ux, uy);
+                    DStarUpdateVertex(ds, ux, uy);
+                }
+                ds->rhs[CellIndex(ds->width, x, y)] = DStarLookahead(ds, x, y);
+                DStarUpdateVertex(ds, x, y);
+            }
+        }
+    }
+
+    // D* Lite: keeps its search between ticks and only repairs cells whose entry cost
+    // changed. Its heuristic is unweighted, so paths cost the same as A* at weighting 1.00.
+    void PlanPathDStarLite(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        DStarLite *ds = &ctx->dstar;
+        ctx->searchNodesExpanded = 0;
+
+        // g values are distances to the goal, so a new goal means starting again
+        if (!ds->initialised || ctx->dirtyCells.overflowed || targetX != ds->goalX || targetY != ds->goalY) {
+            DStarReset(ctx, ds, startX, startY, targetX, targetY);
+        } else {
+            // The robot moving only shifts every queued key by the same amount
+            ds->keyModifier += GetDistance(ds->startX, ds->startY, startX, startY);
+            ds->startX = startX;
+            ds->startY = startY;
+
+            // A written cell changes its own entry cost and, through mine proximity, its 8 neighbours'
+            DirtyCells *dirty = &ctx->dirtyCells;
+            for (int i = 0; i < dirty->count; i++) {
+                for (int x = max(dirty->x[i] - 1, 0); x <= min(dirty->x[i] + 1, ds->width - 1); x++) {
+                    for (int y = max(dirty->y[i] - 1, 0); y <= min(dirty->y[i] + 1, ds->height - 1); y++) {
+                        int newCost = GetEnterCost(ctx, x, y);
+                        if (newCost != ds->cost[CellIndex(ds->width, x, y)]) DStarApplyCostChange(ds, x, y, newCost);
+                    }
+                }
+            }
+        }
+
+        DStarComputeShortestPath(ctx, ds);
+        if (ds->rhs[CellIndex(ds->width, startX, startY)] >= PATH_COST_INFINITY) return;
+
+        // Walk downhill through g, then flip the steps to target-first like the other planners.
+        // currentPathLen stays 0 until the walk is known to arrive.
+        int stepCount = 0;
+        int x = startX;
+        int y = startY;
+        while ((x != targetX || y != targetY) && stepCount < ctx->window.cellCount) {
+            int bestCost = PATH_COST_INFINITY;
+            int bestX = -1, bestY = -1;
+            for (int i = 0; i < 4; i++) {
+                int nx = x + DIR_VECTORS[i].x;
+                int ny = y + DIR_VECTORS[i].y;
+                if (nx < 0 || nx >= ds->width || ny < 0 || ny >= ds->height) continue;
+                int viaCost = AddPathCost(ds->cost[CellIndex(ds->width, nx, ny)], ds->nodes[CellIndex(ds->width, nx, ny)].gCost);
+                if (viaCost < bestCost) {
+                    bestCost = viaCost;
+                    bestX = nx;
+                    bestY = ny;
+                }
+            }
+            if (bestX == -1) return;
+            ctx->currentPath[stepCount++] = (GridPos){bestX, bestY};
+            x = bestX;
+            y = bestY;
+        }
+        if (x != targetX || y != targetY) return;
+
+        for (int i = 0; i < stepCount / 2; i++) {
+            GridPos tmp = ctx->currentPath[i];
+            ctx->currentPath[i] = ctx->currentPath[stepCount - 1 - i];
+            ctx->currentPath[stepCount - 1 - i] = tmp;
+        }
+        ctx->currentPathLen = stepCount;
+    }
+
+    // Multi-source Dijkstra seeded from every live person in the window at once, so the cost doesn't
+    // grow with NUM_PEOPLE. Each settled cell's parent points downhill towards its nearest person (the
+    // flow field). The sweep stops as soon as the robot's cell is settled, and following its parents
+    // leads to the person who is truly closest once walls and mine penalties are counted. The target
+    // is only a source when it is the waypoint to someone outside the window.
+    void PlanPathFlowField(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        BeginSearch(ws);
+        ctx->searchNodesExpanded = 0;
+
+        GridPos sources[NUM_PEOPLE + 1];
+        int sourceCount = 0;
+        for (int i = 0; i < ctx->people.count; i++) {
+            if (!EntityIsActive(&ctx->people, i)) continue;
+            GridPos person = WorldToWindow(ctx, EntityPosition(&ctx->people, i));
+            if (IsInsideWindow(ctx, person.x, person.y)) sources[sourceCount++] = person;
+        }
+        // Whoever the AI picked is beyond the window, so the way there counts as a person too
+        if (ctx->window.targetOutside) sources[sourceCount++] = (GridPos){targetX, targetY};
+        for (int i = 0; i < sourceCount; i++) {
+            Node *source = GetSearchNode(ws, sources[i].x, sources[i].y);
+            if (source->open) continue;
+            source->gCost = 0;
+            source->hCost = 0;
+            source->fCost = 0;
+            source->open = true;
+            OpenSetPush(&ws->openSet, source);
+        }
+
+        Node *robotNode = NULL;
+        while (robotNode == NULL) {
+            Node *current = OpenSetPop(&ws->openSet);
+            if (current == NULL) return; // Nobody is reachable
+            ctx->searchNodesExpanded++;
+            current->open = false;
+            current->closed = true;
+
+            if (current->x == startX && current->y == startY) {
+                robotNode = current;
+                break;
+            }
+
+            // Searching outwards from the people, so a neighbour reaches us by stepping into current
+            if (IsRobotSpawn(ctx, current->x, current->y)) continue; // Nothing may step in
+            int stepCost = GetEnterCost(ctx, current->x, current->y);
+            for (int i = 0; i < 4; i++) {
+                int checkX = current->x + DIR_VECTORS[i].x;
+                int checkY = current->y + DIR_VECTORS[i].y;
+                if (!IsInsideWindow(ctx, checkX, checkY)) continue;
+
+                if (IsWallCell(ctx, checkX, checkY) || IsMineCell(ctx, checkX, checkY)) continue;
+                Node *neighbour = GetSearchNode(ws, checkX, checkY);
+                if (neighbour->closed) continue;
+
+                int moveCost = current->gCost + stepCost;
+                if (moveCost < neighbour->gCost || !neighbour->open) {
+                    neighbour->gCost = moveCost;
+                    neighbour->fCost = moveCost;
+                    neighbour->parentX = current->x;
+                    neighbour->parentY = current->y;
+                    if (neighbour->open) OpenSetDecreaseKey(&ws->openSet, neighbour);
+                    else OpenSetPush(&ws->openSet, neighbour);
+                    neighbour->open = true;
+                }
+            }
+        }
+
+        // Follow the parents downhill (next step first), then flip to the target-first order
+        int traceX = robotNode->parentX;
+        int traceY = robotNode->parentY;
+        while (traceX != -1 && ctx->currentPathLen < ctx->window.cellCount) {
+            ctx->currentPath[ctx->currentPathLen++] = (GridPos){traceX, traceY};
+            Node *step = &ws->nodes[CellIndex(ws->width, traceX, traceY)];
+            traceX = step->parentX;
+            traceY = step->parentY;
+        }
+        for (int i = 0; i < ctx->currentPathLen / 2; i++) {
+            GridPos tmp = ctx->currentPath[i];
+            ctx->currentPath[i] = ctx->currentPath[ctx->currentPathLen - 1 - i];
+            ctx->currentPath[ctx->currentPathLen - 1 - i] = tmp;
+        }
+    }
+
+    // The respawn point never moves within an arena, so the jump tables can count it as a wall
+    static bool JpsIsWall(GameContext *ctx, int x, int y) {
+        if (!IsInsideWindow(ctx, x, y)) return true;
+        return IsWallCell(ctx, x, y) || IsRobotSpawn(ctx, x, y);
+    }
+
+    static bool JpsIsPassable(GameContext *ctx, int x, int y) {
+        if (!IsInsideWindow(ctx, x, y)) return false;
+        return !JpsIsWall(ctx, x, y) && !IsMineCell(ctx, x, y);
+    }
+
+    // Plain cells cost exactly 1 to enter. Jumps may only skip over plain cells, since the
+    // symmetry JPS prunes relies on every equal-length route also costing the same.
+    static bool JpsIsPlain(GameContext *ctx, int x, int y) {
+        return JpsIsPassable(ctx, x, y) && !IsNearMine(ctx, x, y);
+    }
+
+
+    // Rebuilds the vertical jump distances from the walls alone, one sweep per column and direction
+    static void JpsBuildJumpTables(GameContext *ctx) {
+        JumpPointTables *jps = &ctx->jps;
+        int width = ctx->window.width;
+        for (int d = 0; d < 2; d++) {
+            int dy = (d == 0) ? -1 : 1;
+            int *jump = jps->jumpDistance[d];
+            // Sweep against the direction of travel so the next row is already known
+            for (int i = 0; i < ctx->window.height; i++) {
+                int y = (dy == 1) ? ctx->window.height - 1 - i : i;
+                int nextY = y + dy;
+                for (int x = 0; x < width; x++) {
+                    if (JpsIsWall(ctx, x, y) || JpsIsWall(ctx, x, nextY)) {
+                        jump[CellIndex(width, x, y)] = 0;
+                        continue;
+                    }
+                    // Arriving at nextY, a side cell is forced if the wall behind it blocks the cheaper corner
+                    bool forced = false;
+                    for (int side = -1; side <= 1; side += 2) {
+                        if (!JpsIsWall(ctx, x + side, nextY) && JpsIsWall(ctx, x + side, y)) forced = true;
+                    }
+                    int further = jump[CellIndex(width, x, nextY)];
+                    if (forced) jump[CellIndex(width, x, y)] = 1;
+                    else jump[CellIndex(width, x, y)] = (further > 0) ? further + 1 : further - 1;
+                }
+            }
+        }
+        jps->tablesStale = false;
+    }
+
+    // Recounts the mines' footprint in O(cells), for searches that follow a mine move
+    static void JpsBuildHazardCounts(GameContext *ctx) {
+        for (int x = 0; x < ctx->window.width; x++) {
+            int *column = &ctx->jps.hazardPrefix[x * (ctx->window.height + 1)];
+            column[0] = 0;
+            for (int y = 0; y < ctx->window.height; y++) {
+                bool hazard = IsMineCell(ctx, x, y) || IsNearMine(ctx, x, y);
+                column[y + 1] = column[y] + hazard;
+            }
+        }
+        ctx->jps.hazardsStale = false;
+    }
+
+    // Number of mine / near-mine cells in column x between rows y0 and y1 (either order)
+    static int JpsColumnHazards(GameContext *ctx, int x, int y0, int y1) {
+        if (x < 0 || x >= ctx->window.width) return 0;
+        int *column = &ctx->jps.hazardPrefix[x * (ctx->window.height + 1)];
+        int lo = min(y0, y1);
+        int hi = max(y0, y1);
+        return column[hi + 1] - column[lo];
+    }
+
+    // Moves vertically from (x, y) until a jump point: the target, a cell that isn't plain, or a
+    // cell whose side neighbour can't be reached as cheaply by turning earlier. Returns false if
+    // the run hits a wall or mine first.
+    static bool JpsJumpVertical(GameContext *ctx, int x, int y, int dy, int targetX, int targetY, int *outY) {
+        int steps = ctx->jps.jumpDistance[dy == 1][CellIndex(ctx->window.width, x, y)];
+        int reach = abs(steps);
+        bool targetInRun = (x == targetX && (targetY - y)*dy >= 1 && (targetY - y)*dy <= reach);
+        int runLength = targetInRun ? (targetY - y)*dy : reach;
+
+        // Fast path: the walls decide everything unless a mine's footprint touches this column or the
+        // cells beside it (a hazard behind a side cell can force a turn the wall table doesn't know about)
+        if (runLength > 0
+            && JpsColumnHazards(ctx, x, y + dy, y + dy*runLength) == 0
+            && JpsColumnHazards(ctx, x - 1, y, y + dy*(runLength - 1)) == 0
+            && JpsColumnHazards(ctx, x + 1, y, y + dy*(runLength - 1)) == 0) {
+            if (targetInRun) { *outY = targetY; return true; }
+            if (steps > 0) { *outY = y + dy*steps; return true; }
+            return false;
+        }
+
+        // Slow path: step through the run checking each cell
+        int cy = y;
+        while (true) {
+            cy += dy;
+            if (!JpsIsPassable(ctx, x, cy)) return false;
+            if ((x == targetX && cy == targetY) || !JpsIsPlain(ctx, x, cy)) { *outY = cy; return true; }
+            for (int side = -1; side <= 1; side += 2) {
+                if (JpsIsPassable(ctx, x + side, cy) && !JpsIsPlain(ctx, x + side, cy - dy)) { *outY = cy; return true; }
+            }
+        }
+    }
+
+    // Moves horizontally from (x, y). Every cell on a horizontal run may turn vertically, so a cell
+    // is a jump point if either vertical run from it finds one.
+    static bool JpsJumpHorizontal(GameContext *ctx, int x, int y, int dx, int targetX, int targetY, int *outX) {
+        int cx = x;
+        int ignoredY;
+        while (true) {
+            cx += dx;
+            if (!JpsIsPassable(ctx, cx, y)) return false;
+            if ((cx == targetX && y == targetY) || !JpsIsPlain(ctx, cx, y)
+                || JpsJumpVertical(ctx, cx, y, -1, targetX, targetY, &ignoredY)
+                || JpsJumpVertical(ctx, cx, y, 1, targetX, targetY, &ignoredY)) {
+                *outX = cx;
+                return true;
+            }
+        }
+    }
+
+    // Jump Point Search for 4-connected movement. Paths are canonically ordered horizontal-first:
+    // a vertical run only turns where a wall or hazard makes the earlier turn unavailable. Only jump
+    // points go on the open set, and the straight runs between them are filled back in at the end.
+    void PlanPathJPS(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        if (ctx->jps.tablesStale) JpsBuildJumpTables(ctx);
+        if (ctx->jps.hazardsStale) JpsBuildHazardCounts(ctx);
+
+        SearchWorkspace *ws = &ctx->searchWorkspace;
+        BeginSearch(ws);
+        ctx->searchNodesExpanded = 0;
+
+        Node *startNode = GetSearchNode(ws, startX, startY);
+        startNode->gCost = 0;
+        startNode->hCost = GetDistance(startX, startY, targetX, targetY);
+        startNode->fCost = startNode->hCost;
+        startNode->open = true;
+        OpenSetPush(&ws->openSet, startNode);
+
+        Node *targetNode = NULL;
+        while (targetNode == NULL) {
+            Node *current = OpenSetPop(&ws->openSet);
+            if (current == NULL) return;
+            ctx->searchNodesExpanded++;
+            current->open = false;
+            current->closed = true;
+            if (current->x == targetX && current->y == targetY) {
+                targetNode = current;
+                break;
+            }
+
+            // Work out which directions are still worth exploring from here
+            int x = current->x;
+            int y = current->y;
+            bool dirOpen[4] = {true, true, true, true};
+            if (current->parentX != -1 && JpsIsPlain(ctx, x, y)) {
+                int dx = (x > current->parentX) - (x < current->parentX);
+                int dy = (y > current->parentY) - (y < current->parentY);
+                for (int i = 0; i < 4; i++) dirOpen[i] = false;
+                if (dx != 0) {
+                    // Horizontal: carry on, or turn either way
+                    dirOpen[dx == 1 ? EAST : WEST] = true;
+                    dirOpen[NORTH] = true;
+                    dirOpen[SOUTH] = true;
+                } else {
+                    // Vertical: carry on, and only turn where the corner behind is blocked or dearer
+                    dirOpen[dy == 1 ? SOUTH : NORTH] = true;
+                    if (JpsIsPassable(ctx, x + 1, y) && !JpsIsPlain(ctx, x + 1, y - dy)) dirOpen[EAST] = true;
+                    if (JpsIsPassable(ctx, x - 1, y) && !JpsIsPlain(ctx, x - 1, y - dy)) dirOpen[WEST] = true;
+                }
+            }
+
+            for (int i = 0; i < 4; i++) {
+                if (!dirOpen[i]) continue;
+                int jumpX = x;
+                int jumpY = y;
+                bool found = (DIR_VECTORS[i].x != 0)
+                    ? JpsJumpHorizontal(ctx, x, y, DIR_VECTORS[i].x, targetX, targetY, &jumpX)
+                    : JpsJumpVertical(ctx, x, y, DIR_VECTORS[i].y, targetX, targetY, &jumpY);
+                if (!found) continue;
+
+                Node *neighbour = GetSearchNode(ws, jumpX, jumpY);
+                if (neighbour->closed) continue;
+
+                // Every cell skipped over was plain, so only the landing cell can carry a penalty
+                int runLength = GetDistance(x, y, jumpX, jumpY);
+                int moveCost = current->gCost + (runLength - 1) + GetEnterCost(ctx, jumpX, jumpY);
+                if (moveCost < neighbour->gCost || !neighbour->open) {
+                    neighbour->gCost = moveCost;
+                    neighbour->hCost = (int)(GetDistance(jumpX, jumpY, targetX, targetY) * ctx->AStarHeuristicWeightage);
+                    neighbour->fCost = neighbour->gCost + neighbour->hCost;
+                    neighbour->parentX = x;
+                    neighbour->parentY = y;
+                    if (neighbour->open) OpenSetDecreaseKey(&ws->openSet, neighbour);
+                    else OpenSetPush(&ws->openSet, neighbour);
+                    neighbour->open = true;
+                }
+            }
+        }
+
+        // Retrace the jump points, filling in every cell of the straight run back to each parent
+        Node *node = targetNode;
+        while (node->parentX != -1) {
+            int stepX = (node->parentX > node->x) - (node->parentX < node->x);
+            int stepY = (node->parentY > node->y) - (node->parentY < node->y);
+            for (int cx = node->x, cy = node->y; cx != node->parentX || cy != node->parentY; cx += stepX, cy += stepY) {
+                ctx->currentPath[ctx->currentPathLen++] = (GridPos){cx, cy};
+            }
+            node = &ws->nodes[CellIndex(ws->width, node->parentX, node->parentY)];
+        }
+    }
+
+    // A wall change at (x, y) affects its own cluster, and the neighbouring one too if it sits
+    // on their shared border (the entrances along that border depend on both sides)
+    void MarkClustersStale(GameContext *ctx, int x, int y) {
+        HierarchicalMap *hpa = &ctx->hpa;
+        int cx = x / HPA_CLUSTER_SIZE;
+        int cy = y / HPA_CLUSTER_SIZE;
+        bool *stale = &hpa->clusterStale[cy * hpa->clustersX + cx];
+        stale[0] = true;
+        if (x % HPA_CLUSTER_SIZE == 0 && cx > 0) stale[-1] = true;
+        if (x % HPA_CLUSTER_SIZE == HPA_CLUSTER_SIZE - 1 && cx < hpa->clustersX - 1) stale[1] = true;
+        if (y % HPA_CLUSTER_SIZE == 0 && cy > 0) stale[-hpa->clustersX] = true;
+        if (y % HPA_CLUSTER_SIZE == HPA_CLUSTER_SIZE - 1 && cy < hpa->clustersY - 1) stale[hpa->clustersX] = true;
+    }
+
+    static void HpaClusterBounds(GameContext *ctx, int cx, int cy, int *x0, int *y0, int *x1, int *y1) {
+        *x0 = cx * HPA_CLUSTER_SIZE;
+        *y0 = cy * HPA_CLUSTER_SIZE;
+        *x1 = min(*x0 + HPA_CLUSTER_SIZE, ctx->window.width) - 1;
+        *y1 = min(*y0 + HPA_CLUSTER_SIZE, ctx->window.height) - 1;
+    }
+
+    // Cell of a slot, and the cell just across the border from it. Returns false if the
+    // slot runs past the end of a smaller edge cluster.
+    static bool HpaSlotCell(GameContext *ctx, int cx, int cy, int slot, int *x, int *y, int *acrossX, int *acrossY) {
+        int x0, y0, x1, y1;
+        HpaClusterBounds(ctx, cx, cy, &x0, &y0, &x1, &y1);
+        Direction side = (Direction)(slot / HPA_CLUSTER_SIZE);
+        int pos = slot % HPA_CLUSTER_SIZE;
+        switch (side) {
+            case NORTH: *x = x0 + pos; *y = y0; break;
+            case EAST:  *x = x1; *y = y0 + pos; break;
+            case SOUTH: *x = x0 + pos; *y = y1; break;
+            case WEST:  *x = x0; *y = y0 + pos; break;
+        }
+        *acrossX = *x + DIR_VECTORS[side].x;
+        *acrossY = *y + DIR_VECTORS[side].y;
+        return *x <= x1 && *y <= y1;
+    }
+
+    static int HpaNodeId(HierarchicalMap *hpa, int cx, int cy, int slot) {
+        return (cy * hpa->clustersX + cx) * HPA_SLOTS_PER_CLUSTER + slot;
+    }
+
+    // Breadth-first distances over non-wall cells, staying inside one cluster.
+    // dist is a HPA_CLUSTER_SIZE^2 block indexed by the cell's offset in the cluster, -1 if unreachable.
+    static void HpaClusterBfs(GameContext *ctx, int cx, int cy, int fromX, int fromY, short *dist) {
+        int x0, y0, x1, y1;
+        HpaClusterBounds(ctx, cx, cy, &x0, &y0, &x1, &y1);
+        int queueX[HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE];
+        int queueY[HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE];
+        int head = 0, tail = 0;
+
+        for (int i = 0; i < HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE; i++) dist[i] = -1;
+        dist[(fromY - y0) * HPA_CLUSTER_SIZE + (fromX - x0)] = 0;
+        queueX[tail] = fromX;
+        queueY[tail] = fromY;
+        tail++;
+
+        while (head < tail) {
+            int x = queueX[head];
+            int y = queueY[head];
+            head++;
+            short here = dist[(y - y0) * HPA_CLUSTER_SIZE + (x - x0)];
+            for (int i = 0; i < 4; i++) {
+                int nx = x + DIR_VECTORS[i].x;
+                int ny = y + DIR_VECTORS[i].y;
+                if (nx < x0 || nx > x1 || ny < y0 || ny > y1) continue;
+                if (IsWallCell(ctx, nx, ny) || IsRobotSpawn(ctx, nx, ny)) continue;
+                short *d = &dist[(ny - y0) * HPA_CLUSTER_SIZE + (nx - x0)];
+                if (*d != -1) continue;
+                *d = here + 1;
+                queueX[tail] = nx;
+                queueY[tail] = ny;
+                tail++;
+            }
+        }
+    }
+
+    // Re-derives one cluster's entrances and the distances between them. Each open run along a
+    // border gets one entrance in its middle, or one at each end if it is long.
+    static void HpaRebuildCluster(GameContext *ctx, int cx, int cy) {
+        HierarchicalMap *hpa = &ctx->hpa;
+        int cluster = cy * hpa->clustersX + cx;
+        bool *active = &hpa->active[cluster * HPA_SLOTS_PER_CLUSTER];
+        short *distance = &hpa->distance[cluster * HPA_SLOTS_PER_CLUSTER * HPA_SLOTS_PER_CLUSTER];
+        for (int slot = 0; slot < HPA_SLOTS_PER_CLUSTER; slot++) active[slot] = false;
+
+        for (int side = 0; side < 4; side++) {
+            int runStart = -1;
+            for (int pos = 0; pos <= HPA_CLUSTER_SIZE; pos++) {
+                int x, y, ax, ay;
+                bool open = pos < HPA_CLUSTER_SIZE
+                    && HpaSlotCell(ctx, cx, cy, side*HPA_CLUSTER_SIZE + pos, &x, &y, &ax, &ay)
+                    && IsInsideWindow(ctx, ax, ay)
+                    && !IsWallCell(ctx, x, y) && !IsWallCell(ctx, ax, ay)
+                    && !IsRobotSpawn(ctx, x, y) && !IsRobotSpawn(ctx, ax, ay);
+                if (open && runStart == -1) runStart = pos;
+                if (!open && runStart != -1) {
+                    int runEnd = pos - 1;
+                    if (runEnd - runStart + 1 >= 6) {
+                        active[side*HPA_CLUSTER_SIZE + runStart] = true;
+                        active[side*HPA_CLUSTER_SIZE + runEnd] = true;
+                    } else {
+                        active[side*HPA_CLUSTER_SIZE + (runStart + runEnd)/2] = true;
+                    }
+                    runStart = -1;
+                }
+            }
+        }
+
+        int x0, y0, x1, y1;
+        HpaClusterBounds(ctx, cx, cy, &x0, &y0, &x1, &y1);
+        short dist[HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE];
+        for (int from = 0; from < HPA_SLOTS_PER_CLUSTER; from++) {
+            if (!active[from]) continue;
+            int fx, fy, ax, ay;
+            HpaSlotCell(ctx, cx, cy, from, &fx, &fy, &ax, &ay);
+            HpaClusterBfs(ctx, cx, cy, fx, fy, dist);
+            for (int to = 0; to < HPA_SLOTS_PER_CLUSTER; to++) {
+                int tx, ty;
+                distance[from * HPA_SLOTS_PER_CLUSTER + to] = -1;
+                if (!active[to]) continue;
+                HpaSlotCell(ctx, cx, cy, to, &tx, &ty, &ax, &ay);
+                distance[from * HPA_SLOTS_PER_CLUSTER + to] = dist[(ty - y0) * HPA_CLUSTER_SIZE + (tx - x0)];
+            }
+        }
+        hpa->clusterStale[cluster] = false;
+    }
+
+    static Node* HpaGetNode(HierarchicalMap *hpa, int id, int x, int y) {
+        Node *node = &hpa->nodes[id];
+        if (node->generation != hpa->generation) {
+            *node = (Node){x, y, 9999, 9999, 9999, -1, -1, false, false, -1, hpa->generation};
+        }
+        return node;
+    }
+
+    static void HpaRelax(GameContext *ctx, Node *from, int toId, int toX, int toY, int edgeCost, int targetX, int targetY) {
+        HierarchicalMap *hpa = &ctx->hpa;
+        Node *to = HpaGetNode(hpa, toId, toX, toY);
+        if (to->closed) return;
+        int moveCost = from->gCost + edgeCost;
+        if (moveCost < to->gCost || !to->open) {
+            to->gCost = moveCost;
+            to->hCost = GetDistance(toX, toY, targetX, targetY);
+            to->fCost = to->gCost + to->hCost;
+            to->parentX = (int)(from - hpa->nodes);
+            if (to->open) OpenSetDecreaseKey(&hpa->queue, to);
+            else OpenSetPush(&hpa->queue, to);
+            to->open = true;
+        }
+    }
+
+    // Hierarchical A*: plan over cluster entrances using the cached wall-only distances, then
+    // refine just the leg to the next entrance with the full A* (which sees mines). Painting a
+    // wall only rebuilds the clusters it touches.
+    void PlanPathHPA(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        HierarchicalMap *hpa = &ctx->hpa;
+        for (int cy = 0; cy < hpa->clustersY; cy++) {
+            for (int cx = 0; cx < hpa->clustersX; cx++) {
+                if (hpa->clusterStale[cy * hpa->clustersX + cx]) HpaRebuildCluster(ctx, cx, cy);
+            }
+        }
+
+        int startCX = startX / HPA_CLUSTER_SIZE, startCY = startY / HPA_CLUSTER_SIZE;
+        int targetCX = targetX / HPA_CLUSTER_SIZE, targetCY = targetY / HPA_CLUSTER_SIZE;
+        if (startCX == targetCX && startCY == targetCY) {
+            // Nothing to abstract over, and the target may only be reachable by leaving the cluster
+            PlanPathAStar(ctx, startX, startY, targetX, targetY);
+            return;
+        }
+
+        // Temporary edges from the robot and to the target, within their own clusters
+        short startDist[HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE];
+        short targetDist[HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE];
+        HpaClusterBfs(ctx, startCX, startCY, startX, startY, startDist);
+        HpaClusterBfs(ctx, targetCX, targetCY, targetX, targetY, targetDist);
+
+        hpa->queue.count = 0;
+        hpa->generation++;
+        if (hpa->generation == 0) {
+            for (int i = 0; i < hpa->nodeCount + 2; i++) hpa->nodes[i].generation = 0;
+            hpa->generation = 1;
+        }
+        int startId = hpa->nodeCount;
+        int targetId = hpa->nodeCount + 1;
+        Node *startNode = HpaGetNode(hpa, startId, startX, startY);
+        startNode->gCost = 0;
+        startNode->hCost = GetDistance(startX, startY, targetX, targetY);
+        startNode->fCost = startNode->hCost;
+        startNode->open = true;
+        OpenSetPush(&hpa->queue, startNode);
+
+        int abstractExpanded = 0;
+        Node *targetNode = NULL;
+        while (targetNode == NULL) {
+            Node *current = OpenSetPop(&hpa->queue);
+            if (current == NULL) break;
+            abstractExpanded++;
+            current->open = false;
+            current->closed = true;
+            int id = (int)(current - hpa->nodes);
+            if (id == targetId) {
+                targetNode = current;
+                break;
+            }
+
+            int x0, y0, x1, y1;
+            if (id == startId) {
+                HpaClusterBounds(ctx, startCX, startCY, &x0, &y0, &x1, &y1);
+                for (int slot = 0; slot < HPA_SLOTS_PER_CLUSTER; slot++) {
+                    if (!hpa->active[HpaNodeId(hpa, startCX, startCY, slot)]) continue;
+                    int sx, sy, ax, ay;
+                    HpaSlotCell(ctx, startCX, startCY, slot, &sx, &sy, &ax, &ay);
+                    short d = startDist[(sy - y0) * HPA_CLUSTER_SIZE + (sx - x0)];
+                    if (d >= 0) HpaRelax(ctx, current, HpaNodeId(hpa, startCX, startCY, slot), sx, sy, d, targetX, targetY);
+                }
+                continue;
+            }
+
+            int cluster = id / HPA_SLOTS_PER_CLUSTER;
+            int cx = cluster % hpa->clustersX;
+            int cy = cluster / hpa->clustersX;
+            int slot = id % HPA_SLOTS_PER_CLUSTER;
+            int sx, sy, ax, ay;
+            HpaSlotCell(ctx, cx, cy, slot, &sx, &sy, &ax, &ay);
+
+            // Across the border: the matching slot on the opposite side of the neighbour
+            Direction side = (Direction)(slot / HPA_CLUSTER_SIZE);
+            int ncx = cx + DIR_VECTORS[side].x;
+            int ncy = cy + DIR_VECTORS[side].y;
+            int partner = ((side + 2) % 4) * HPA_CLUSTER_SIZE + slot % HPA_CLUSTER_SIZE;
+            HpaRelax(ctx, current, HpaNodeId(hpa, ncx, ncy, partner), ax, ay, 1, targetX, targetY);
+
+            // Within the cluster: cached distances to the other entrances, and to the target if it's here
+            for (int other = 0; other < HPA_SLOTS_PER_CLUSTER; other++) {
+                short d = hpa->distance[id * HPA_SLOTS_PER_CLUSTER + other];
+                if (other == slot || d < 0) continue;
+                int ox, oy;
+                HpaSlotCell(ctx, cx, cy, other, &ox, &oy, &ax, &ay);
+                HpaRelax(ctx, current, HpaNodeId(hpa, cx, cy, other), ox, oy, d, targetX, targetY);
+            }
+            if (cx == targetCX && cy == targetCY) {
+                HpaClusterBounds(ctx, cx, cy, &x0, &y0, &x1, &y1);
+                short d = targetDist[(sy - y0) * HPA_CLUSTER_SIZE + (sx - x0)];
+                if (d >= 0) HpaRelax(ctx, current, targetId, targetX, targetY, d, targetX, targetY);
+            }
+        }
+
+        if (targetNode == NULL) {
+            ctx->searchNodesExpanded = abstractExpanded;
+            return;
+        }
+
+        // The first abstract waypoint that isn't the robot's own cell is the only leg refined now
+        Node *waypoint = targetNode;
+        for (Node *node = targetNode; node->parentX != -1; node = &hpa->nodes[node->parentX]) {
+            if (node->x != startX || node->y != startY) waypoint = node;
+        }
+        PlanPathAStar(ctx, startX, startY, waypoint->x, waypoint->y);
+        if (ctx->currentPathLen == 0) {
+            // The abstract graph only knows walls, so the waypoint may hold a mine right now. The
+            // target can still be reachable another way, so search for it directly.
+            int legExpanded = ctx->searchNodesExpanded;
+            PlanPathAStar(ctx, startX, startY, targetX, targetY);
+            ctx->searchNodesExpanded += legExpanded;
+        }
+        ctx->searchNodesExpanded += abstractExpanded;
+    }
+
+    // Adds probability p of a mine being at (x, y) facing dir, merging with a matching state
+    static void SpaceTimeAddState(GameContext *ctx, MineState *states, int *count, int x, int y, Direction dir, float p) {
+        unsigned char *slot = &ctx->spaceTime.stateSlot[CellIndex(ctx->window.width, x, y) * 4 + dir];
+        if (*slot != 0) {
+            states[*slot - 1].probability += p;
+            return;
+        }
+        states[*count] = (MineState){x, y, dir, p};
+        *slot = (unsigned char)++(*count);
+    }
+
+    static int CompareMineStates(const void *a, const void *b) {
+        float pa = ((const MineState*)a)->probability;
+        float pb = ((const MineState*)b)->probability;
+        return (pa < pb) - (pa > pb); // most likely first
+    }
+
+    // Clears the merge slots and keeps only the most likely states so every mine costs the same to predict
+    static void SpaceTimePruneStates(GameContext *ctx, MineState *states, int *count) {
+        for (int i = 0; i < *count; i++) ctx->spaceTime.stateSlot[CellIndex(ctx->window.width, states[i].x, states[i].y) * 4 + states[i].direction] = 0;
+        if (*count > SPACETIME_MAX_MINE_STATES) {
+            qsort(states, *count, sizeof(MineState), CompareMineStates);
+            *count = SPACETIME_MAX_MINE_STATES;
+        }
+    }
+
+    // Window cell (x, y) within one layer of the box, or -1 if it lies outside the box
+    static int SpaceTimeBoxIndex(SpaceTimePlanner *st, int x, int y) {
+        int bx = x - st->boxX;
+        int by = y - st->boxY;
+        if (bx < 0 || bx >= st->width || by < 0 || by >= st->height) return -1;
+        return CellIndex(st->width, bx, by);
+    }
+
+    // Fills the reservation table by rolling each nearby mine's movement odds forward frame by
+    // frame, mirroring RollEntityPool: maybe turn (half the time clockwise), then maybe step
+    // forward unless a wall or the edge of the window is in the way.
+    static void SpaceTimePredictMines(GameContext *ctx, int startX, int startY, int horizon, int framesPerMove) {
+        SpaceTimePlanner *st = &ctx->spaceTime;
+        memset(st->reservation, 0, sizeof(float) * (SPACETIME_HORIZON + 1) * st->cellCount);
+
+        EntityPool *mines = &ctx->mines;
+        for (int m = 0; m < mines->count; m++) {
+            if (!EntityIsActive(mines, m)) continue;
+            GridPos mine = WorldToWindow(ctx, EntityPosition(mines, m));
+            // Mines rarely cover more than a few cells in the window, so far ones can't reach our routes
+            if (GetDistance(mine.x, mine.y, startX, startY) > horizon + 6 || !IsInsideWindow(ctx, mine.x, mine.y)) continue;
+
+            MineState states[SPACETIME_MAX_MINE_STATES];
+            MineState next[SPACETIME_MAX_MINE_STATES * 4];
+            int count = 1;
+            states[0] = (MineState){mine.x, mine.y, (Direction)mines->direction[m], 1.0f};
+            float pTurn = mines->turnChance[m] * 0.5f / ENTITY_CHANCE_ONE;
+            float pMove = (float)mines->moveChance[m] / ENTITY_CHANCE_ONE;
+
+            for (int frame = 1; frame <= horizon * framesPerMove; frame++) {
+                int nextCount = 0;
+                for (int i = 0; i < count; i++) {
+                    MineState s = states[i];
+                    for (int turned = 0; turned <= 1; turned++) {
+                        float p = s.probability * (turned ? pTurn : 1.0f - pTurn);
+                        Direction dir = (Direction)((s.direction + turned) % 4);
+                        int nx = s.x + DIR_VECTORS[dir].x;
+                        int ny = s.y + DIR_VECTORS[dir].y;
+                        bool blocked = !IsInsideWindow(ctx, nx, ny) || IsWallCell(ctx, nx, ny);
+                        SpaceTimeAddState(ctx, next, &nextCount, s.x, s.y, dir, p * (1.0f - pMove));
+                        SpaceTimeAddState(ctx, next, &nextCount, blocked ? s.x : nx, blocked ? s.y : ny, dir, p * pMove);
+                    }
+                }
+                SpaceTimePruneStates(ctx, next, &nextCount);
+                memcpy(states, next, sizeof(MineState) * nextCount);
+                count = nextCount;
+
+                if (frame % framesPerMove == 0) {
+                    int t = frame / framesPerMove;
+                    for (int i = 0; i < count; i++) {
+                        int cell = SpaceTimeBoxIndex(st, states[i].x, states[i].y);
+                        if (cell != -1) st->reservation[t * st->cellCount + cell] += states[i].probability;
+                    }
+                }
+            }
+        }
+    }
+
+    static Node* SpaceTimeGetNode(SpaceTimePlanner *st, int t, int x, int y) {
+        int i = t * st->cellCount + SpaceTimeBoxIndex(st, x, y);
+        Node *node = &st->nodes[i];
+        if (node->generation != st->generation) {
+            *node = (Node){x, y, 9999, 9999, 9999, -1, -1, false, false, -1, st->generation};
+            st->pathRisk[i] = 0.0f;
+        }
+        return node;
+    }
+
+    // Space-time A*: searches (x, y, t) against predicted mine positions rather than treating mines
+    // as fixed. Each move costs 1 plus SPACETIME_RISK_COST per unit of collision chance. Routes whose
+    // total chance passes SPACETIME_RISK_THRESHOLD are dropped. The search ends at the target or
+    // at the horizon (finishing on the wall-aware distance estimate), or when the time budget runs out.
+    void PlanPathSpaceTime(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        SpaceTimePlanner *st = &ctx->spaceTime;
+        double startTime = GetMonotonicTime();
+        int framesPerMove = max(ctx->robot.moveCooldown, 1);
+        int horizon = max(1, min(SPACETIME_HORIZON, SPACETIME_MAX_FRAMES / framesPerMove));
+        st->boxX = startX - SPACETIME_HORIZON;
+        st->boxY = startY - SPACETIME_HORIZON;
+        SpaceTimePredictMines(ctx, startX, startY, horizon, framesPerMove);
+        // Wall-aware distance as the heuristic: Manhattan would leave a horizon-limited search
+        // pacing in front of the first wall it meets
+        BuildStepDistance(ctx, st->goalDistance, st->frontier, targetX, targetY);
+        if (st->goalDistance[CellIndex(ctx->window.width, startX, startY)] == PATH_COST_INFINITY) return;
+
+        st->queue.count = 0;
+        st->generation++;
+        if (st->generation == 0) {
+            memset(st->nodes, 0, sizeof(Node) * (SPACETIME_HORIZON + 1) * st->cellCount);
+            st->generation = 1;
+        }
+        ctx->searchNodesExpanded = 0;
+
+        Node *startNode = SpaceTimeGetNode(st, 0, startX, startY);
+        startNode->gCost = 0;
+        startNode->hCost = st->goalDistance[CellIndex(ctx->window.width, startX, startY)];
+        startNode->fCost = startNode->hCost;
+        startNode->open = true;
+        OpenSetPush(&st->queue, startNode);
+
+        Node *bestNode = startNode; // Fallback if the budget runs out: the expanded node nearest the target
+        Node *endNode = NULL;
+        while (endNode == NULL) {
+            Node *current = OpenSetPop(&st->queue);
+            if (current == NULL) break;
+            int t = (int)((current - st->nodes) / st->cellCount);
+            ctx->searchNodesExpanded++;
+            current->open = false;
+            current->closed = true;
+
+            if ((current->x == targetX && current->y == targetY) || t == horizon) {
+                endNode = current;
+                break;
+            }
+            if (current->hCost < bestNode->hCost) bestNode = current;
+            if ((ctx->searchNodesExpanded & 15) == 0 && SearchBudgetSpent(ctx, startTime, SPACETIME_TIME_BUDGET)) {
+                endNode = bestNode;
+                break;
+            }
+
+            // The robot can't wait in place, but stepping back and forth lets it loiter
+            for (int i = 0; i < 4; i++) {
+                int checkX = current->x + DIR_VECTORS[i].x;
+                int checkY = current->y + DIR_VECTORS[i].y;
+                if (!IsInsideWindow(ctx, checkX, checkY)) continue;
+                int checkCell = CellIndex(ctx->window.width, checkX, checkY);
+                if (st->goalDistance[checkCell] == PATH_COST_INFINITY || IsRobotSpawn(ctx, checkX, checkY)) continue;
+
+                Node *neighbour = SpaceTimeGetNode(st, t + 1, checkX, checkY);
+                if (neighbour->closed) continue;
+
+                float stepRisk = st->reservation[(t + 1) * st->cellCount + SpaceTimeBoxIndex(st, checkX, checkY)];
+                if (stepRisk > 1.0f) stepRisk = 1.0f;
+                float risk = 1.0f - (1.0f - st->pathRisk[current - st->nodes]) * (1.0f - stepRisk);
+                if (risk > SPACETIME_RISK_THRESHOLD) continue;
+
+                int moveCost = current->gCost + 1 + (int)(stepRisk * SPACETIME_RISK_COST);
+                if (moveCost < neighbour->gCost || !neighbour->open) {
+                    neighbour->gCost = moveCost;
+                    neighbour->hCost = (int)(st->goalDistance[checkCell] * ctx->AStarHeuristicWeightage);
+                    neighbour->fCost = neighbour->gCost + neighbour->hCost;
+                    neighbour->parentX = current->x;
+                    neighbour->parentY = current->y;
+                    st->pathRisk[neighbour - st->nodes] = risk;
+                    if (neighbour->open) OpenSetDecreaseKey(&st->queue, neighbour);
+                    else OpenSetPush(&st->queue, neighbour);
+                    neighbour->open = true;
+                }
+            }
+        }
+        if (endNode == NULL || endNode == startNode) return;
+
+        // Each parent sits one time step earlier, so walk back through the layers
+        int t = (int)((endNode - st->nodes) / st->cellCount);
+        Node *node = endNode;
+        while (t > 0) {
+            ctx->currentPath[ctx->currentPathLen++] = (GridPos){node->x, node->y};
+            node = &st->nodes[(t - 1) * st->cellCount + SpaceTimeBoxIndex(st, node->parentX, node->parentY)];
+            t--;
+        }
+    }
+
+    // Whether the other half of a bidirectional search has put a cost on (x, y)
+    static bool SearchReached(SearchWorkspace *ws, int x, int y) {
+        Node *node = &ws->nodes[CellIndex(ws->width, x, y)];
+        return node->generation == ws->generation && (node->open || node->closed);
+    }
+
+    // Expands the cheapest node of one half. Forward, gCost is the cost from the robot and each
+    // neighbour costs its own entry. Backward, gCost is the cost on to the target, so stepping back
+    // to a neighbour costs entering the node being expanded. Meetings with the other half update
+    // bestCost/meetX/meetY.
+    static void ExpandBidirectional(GameContext *ctx, SearchWorkspace *ws, SearchWorkspace *other, bool backward,
+                                    int goalX, int goalY, int *bestCost, int *meetX, int *meetY) {
+        Node *current = OpenSetPop(&ws->openSet);
+        current->open = false;
+        current->closed = true;
+        ctx->searchNodesExpanded++;
+
+        int currentEnterCost = GetEnterCost(ctx, current->x, current->y);
+        int blocked = GetBlockedNeighbours(ctx, current->x, current->y);
+        for (int i = 0; i < 4; i++) {
+            if (blocked & (1 << i)) continue;
+            int checkX = current->x + DIR_VECTORS[i].x;
+            int checkY = current->y + DIR_VECTORS[i].y;
+            Node *neighbour = GetSearchNode(ws, checkX, checkY);
+            if (neighbour->closed) continue;
+
+            int moveCost = current->gCost + (backward ? currentEnterCost : GetEnterCost(ctx, checkX, checkY));
+            if (moveCost < neighbour->gCost || !neighbour->open) {
+                neighbour->gCost = moveCost;
+                neighbour->hCost = GetDistance(checkX, checkY, goalX, goalY);
+                neighbour->fCost = neighbour->gCost + neighbour->hCost;
+                neighbour->parentX = current->x;
+                neighbour->parentY = current->y;
+                if (neighbour->open) OpenSetDecreaseKey(&ws->openSet, neighbour);
+                else OpenSetPush(&ws->openSet, neighbour);
+                neighbour->open = true;
+
+                if (SearchReached(other, checkX, checkY)) {
+                    int total = moveCost + other->nodes[CellIndex(other->width, checkX, checkY)].gCost;
+                    if (total < *bestCost) {
+                        *bestCost = total;
+                        *meetX = checkX;
+                        *meetY = checkY;
+                    }
+                }
+            }
+        }
+    }
+
+    // Bidirectional A*: one search from the robot, one back from the target, each expanding
+    // whichever has fewer open nodes. Uses the unweighted heuristic, which is consistent here,
+    // so stopping once the best meeting cost is no more than the larger of the two open minimum
+    // f-costs gives the optimal path.
+    void PlanPathBidirectional(GameContext *ctx, int startX, int startY, int targetX, int targetY) {
+        SearchWorkspace *forward = &ctx->searchWorkspace;
+        SearchWorkspace *backward = &ctx->reverseWorkspace;
+        BeginSearch(forward);
+        BeginSearch(backward);
+        ctx->searchNodesExpanded = 0;
+
+        Node *startNode = GetSearchNode(forward, startX, startY);
+        startNode->gCost = 0;
+        startNode->hCost = GetDistance(startX, startY, targetX, targetY);
+        startNode->fCost = startNode->hCost;
+        startNode->open = true;
+        OpenSetPush(&forward->openSet, startNode);
+
+        Node *targetNode = GetSearchNode(backward, targetX, targetY);
+        targetNode->gCost = 0;
+        targetNode->hCost = startNode->hCost;
+        targetNode->fCost = targetNode->hCost;
+        targetNode->open = true;
+        OpenSetPush(&backward->openSet, targetNode);
+
+        int bestCost = PATH_COST_INFINITY;
+        int meetX = -1, meetY = -1;
+        while (forward->openSet.count > 0 && backward->openSet.count > 0) {
+            int forwardMin = forward->openSet.items[0]->fCost;
+            int backwardMin = backward->openSet.items[0]->fCost;
+            if (bestCost <= max(forwardMin, backwardMin)) break;
+
+            if (forward->openSet.count <= backward->openSet.count) {
+                ExpandBidirectional(ctx, forward, backward, false, targetX, targetY, &bestCost, &meetX, &meetY);
+            } else {
+                ExpandBidirectional(ctx, backward, forward, true, startX, startY, &bestCost, &meetX, &meetY);
+            }
+        }
+        if (meetX == -1) return;
+
+        // Backward parents lead on to the target: collect them, then flip so the target comes first
+        for (int x = meetX, y = meetY; x != -1; ) {
+            ctx->currentPath[ctx->currentPathLen++] = (GridPos){x, y};
+            Node *node = &backward->nodes[CellIndex(backward->width, x, y)];
+            x = node->parentX;
+            y = node->parentY;
+        }
+        for (int i = 0; i < ctx->currentPathLen / 2; i++) {
+            GridPos tmp = ctx->currentPath[i];
+            ctx->currentPath[i] = ctx->currentPath[ctx->currentPathLen - 1 - i];
+            ctx->currentPath[ctx->currentPathLen - 1 - i] = tmp;
+        }
+        // Forward parents lead back to the robot
+        for (Node *node = &forward->nodes[CellIndex(forward->width, meetX, meetY)]; node->parentX != -1; ) {
+            node = &forward->nodes[CellIndex(forward->width, node->parentX, node->parentY)];
+            ctx->currentPath[ctx->currentPathLen++] = (GridPos){node->x, node->y};
+        }
+        // The robot's own cell isn't a step
+        ctx->currentPathLen--;
+    }
+
+//--------------------------------------------------------------------------------------
+// Rescue Ordering
+//--------------------------------------------------------------------------------------
+    // Exact open tour from the robot through every person (Held-Karp). cost[0][i] is robot to
+    // person i, cost[i + 1][j] is person i to person j. Returns the tour length.
+    static int SolveRescueHeldKarp(RescuePlan *plan, int count, int cost[NUM_PEOPLE + 1][NUM_PEOPLE], int *order) {
+        int full = (1 << count) - 1;
+        for (int mask = 1; mask <= full; mask++) {
+            for (int last = 0; last < count; last++) {
+                plan->heldKarpCost[mask][last] = PATH_COST_INFINITY * (NUM_PEOPLE + 1);
+                plan->heldKarpPrev[mask][last] = -1;
+                if (!(mask & (1 << last))) continue;
+                int rest = mask & ~(1 << last);
+                if (rest == 0) {
+                    plan->heldKarpCost[mask][last] = cost[0][last];
+                    continue;
+                }
+                for (int prev = 0; prev < count; prev++) {
+                    if (!(rest & (1 << prev))) continue;
+                    int total = plan->heldKarpCost[rest][prev] + cost[prev + 1][last];
+                    if (total < plan->heldKarpCost[mask][last]) {
+                        plan->heldKarpCost[mask][last] = total;
+                        plan->heldKarpPrev[mask][last] = (signed char)prev;
+                    }
+                }
+            }
+        }
+
+        int last = 0;
+        for (int i = 1; i < count; i++) {
+            if (plan->heldKarpCost[full][i] < plan->heldKarpCost[full][last]) last = i;
+        }
+        int length = plan->heldKarpCost[full][last];
+        for (int mask = full, slot = count - 1; slot >= 0; slot--) {
+            order[slot] = last;
+            int prev = plan->heldKarpPrev[mask][last];
+            mask &= ~(1 << last);
+            last = prev;
+        }
+        return length;
+    }
+
+    // Nearest neighbour tour tidied by 2-opt, for groups too big for Held-Karp
+    static int SolveRescueHeuristic(int count, int cost[NUM_PEOPLE + 1][NUM_PEOPLE], int *order) {
+        bool used[NUM_PEOPLE] = {false};
+        for (int slot = 0, from = 0; slot < count; slot++) {
+            int best = -1;
+            for (int i = 0; i < count; i++) {
+                if (!used[i] && (best == -1 || cost[from][i] < cost[from][best])) best = i;
+            }
+            used[best] = true;
+            order[slot] = best;
+            from = best + 1;
+        }
+
+        // Reversing order[i..j] only changes the edge into i and the edge out of j (none at the end)
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (int i = 0; i < count - 1; i++) {
+                int before = i == 0 ? 0 : order[i - 1] + 1;
+                for (int j = i + 1; j < count; j++) {
+                    int oldCost = cost[before][order[i]];
+                    int newCost = cost[before][order[j]];
+                    if (j + 1 < count) {
+                        oldCost += cost[order[j] + 1][order[j + 1]];
+                        newCost += cost[order[i] + 1][order[j + 1]];
+                    }
+                    if (newCost >= oldCost) continue;
+                    for (int a = i, b = j; a < b; a++, b--) {
+                        int swap = order[a];
+                        order[a] = order[b];
+                        order[b] = swap;
+                    }
+                    improved = true;
+                }
+            }
+        }
+
+        // 2-opt moved edges around, so total the tour up afresh
+        int length = cost[0][order[0]];
+        for (int slot = 1; slot < count; slot++) length += cost[order[slot - 1] + 1][order[slot]];
+        return length;
+    }
+
+    // One BFS from each live person gives every pairwise step distance, then the visiting order
+    // is solved exactly for small groups and heuristically beyond RESCUE_HELD_KARP_MAX. The BFS only
+    // covers the planning window, so pairs with someone outside it fall back to Manhattan distance.
+    void PlanRescueTour(GameContext *ctx) {
+        RescuePlan *plan = &ctx->rescuePlan;
+        int live[NUM_PEOPLE];
+        GridPos at[NUM_PEOPLE + 1]; // Window cells, the robot first
+        bool inside[NUM_PEOPLE + 1];
+        int count = 0;
+        at[0] = WorldToWindow(ctx, ctx->robot.position);
+        inside[0] = IsInsideWindow(ctx, at[0].x, at[0].y);
+        for (int i = 0; i < NUM_PEOPLE; i++) {
+            plan->plannedAt[i] = EntityPosition(&ctx->people, i);
+            if (!EntityIsActive(&ctx->people, i)) continue;
+            at[count + 1] = WorldToWindow(ctx, plan->plannedAt[i]);
+            inside[count + 1] = IsInsideWindow(ctx, at[count + 1].x, at[count + 1].y);
+            if (inside[count + 1]) {
+                BuildStepDistance(ctx, &plan->distance[count * ctx->window.cellCount], plan->frontier,
+                                  at[count + 1].x, at[count + 1].y);
+            }
+            live[count++] = i;
+        }
+        plan->orderLen = 0;
+        plan->tourLength = 0;
+        plan->stale = false;
+        if (count == 0) return;
+
+        // Row 0 is the robot, row i + 1 is live person i. Reusing person i's BFS for both directions
+        // is fine since steps cost the same either way.
+        int cost[NUM_PEOPLE + 1][NUM_PEOPLE];
+        for (int j = 0; j < count; j++) {
+            int *distance = &plan->distance[j * ctx->window.cellCount];
+            for (int i = 0; i <= count; i++) {
+                cost[i][j] = (inside[i] && inside[j + 1])
+                    ? distance[CellIndex(ctx->window.width, at[i].x, at[i].y)]
+                    : GetDistance(at[i].x, at[i].y, at[j + 1].x, at[j + 1].y);
+            }
+        }
+
+        int order[NUM_PEOPLE];
+        plan->tourLength = count <= RESCUE_HELD_KARP_PEOPLE
+            ? SolveRescueHeldKarp(plan, count, cost, order)
+            : SolveRescueHeuristic(count, cost, order);
+        for (int slot = 0; slot < count; slot++) plan->order[slot] = live[order[slot]];
+        plan->orderLen = count;
+    }
+
+    // Person index to head for next, or -1 when nobody is left. Rescues along the tour just
+    // shorten it. The optimal remainder of an optimal tour is still optimal from where the robot
+    // now stands, so it is only replanned when that stops being true.
+    int NextRescueTarget(GameContext *ctx) {
+        RescuePlan *plan = &ctx->rescuePlan;
+        while (plan->orderLen > 0 && !EntityIsActive(&ctx->people, plan->order[0])) {
+            memmove(plan->order, plan->order + 1, sizeof(int) * --plan->orderLen);
+        }
+
+        bool replan = plan->stale || plan->orderLen == 0;
+        for (int slot = 0; slot < plan->orderLen && !replan; slot++) {
+            GridPos now = EntityPosition(&ctx->people, plan->order[slot]);
+            GridPos then = plan->plannedAt[plan->order[slot]];
+            // Rescued out of turn, or wandered far enough that the order may no longer hold
+            replan = now.x == -1 || GetDistance(now.x, now.y, then.x, then.y) > RESCUE_REPLAN_DISTANCE;
+        }
+        if (replan) PlanRescueTour(ctx);
+
+        return plan->orderLen > 0 ? plan->order[0] : -1;
+    }
+
+//--------------------------------------------------------------------------------------
+// Planning Window & Tile Routes
+// The planners only ever see the window around the robot. On an arena bigger than the window,
+// a route over the world's tiles says which way to leave it (see GetWindowGoal).
+//--------------------------------------------------------------------------------------
+    // Allocates the AI's state the first time it plans, then moves the window along whenever the
+    // robot comes within AI_WINDOW_MARGIN of an edge that isn't also the arena's
+    void PrepareAiWindow(GameContext *ctx) {
+        if (ctx->cellStorage == NULL) AllocateAiState(ctx);
+        PlanningWindow *window = &ctx->window;
+        GridPos robot = WorldToWindow(ctx, ctx->robot.position);
+        bool nearEdge = (window->originX > 0 && robot.x < AI_WINDOW_MARGIN)
+            || (window->originX + window->width < ctx->gridWidth && robot.x >= window->width - AI_WINDOW_MARGIN)
+            || (window->originY > 0 && robot.y < AI_WINDOW_MARGIN)
+            || (window->originY + window->height < ctx->gridHeight && robot.y >= window->height - AI_WINDOW_MARGIN);
+        if (window->placed && !nearEdge) return;
+
+        // Centred on the robot, with inner edges on tile boundaries so route tiles lie wholly in or out
+        int originX = (ctx->robot.position.x - window->width / 2) & ~(WORLD_TILE_SIZE - 1);
+        int originY = (ctx->robot.position.y - window->height / 2) & ~(WORLD_TILE_SIZE - 1);
+        window->originX = max(0, min(originX, ctx->gridWidth - window->width));
+        window->originY = max(0, min(originY, ctx->gridHeight - window->height));
+        window->placed = true;
+        LoadAiWindow(ctx);
+        RefreshMineDanger(ctx);
+        // Their state is in the old window's cells
+        ctx->searchWorkspace.searchActive = false;
+        ctx->dstar.initialised = false;
+    }
+
+    // Rebuilds the bitboards from the world tiles under the window and tells every planner to start over
+    void LoadAiWindow(GameContext *ctx) {
+        PlanningWindow *window = &ctx->window;
+        ClearBitboard(&ctx->bitboards.wall);
+        ClearBitboard(&ctx->bitboards.mine);
+        ClearBitboard(&ctx->bitboards.person);
+        ClearBitboard(&ctx->bitboards.robot);
+        int x1 = window->originX + window->width;
+        int y1 = window->originY + window->height;
+        for (int ty = window->originY >> WORLD_TILE_SHIFT; ty <= (y1 - 1) >> WORLD_TILE_SHIFT; ty++) {
+            for (int tx = window->originX >> WORLD_TILE_SHIFT; tx <= (x1 - 1) >> WORLD_TILE_SHIFT; tx++) {
+                const WorldTile *tile = ctx->world.directory[ty * ctx->world.tilesX + tx];
+                if (tile == NULL) continue;
+                for (int y = max(tile->originY, window->originY); y < min(tile->originY + WORLD_TILE_SIZE, y1); y++) {
+                    for (int x = max(tile->originX, window->originX); x < min(tile->originX + WORLD_TILE_SIZE, x1); x++) {
+                        Bitboard *bits = GetCellBitboard(ctx, tile->cells[(y - tile->originY) * WORLD_TILE_SIZE + (x - tile->originX)]);
+                        if (bits != NULL) BitboardSet(bits, x - window->originX, y - window->originY);
+                    }
+                }
+            }
+        }
+
+        ctx->dirtyCells.overflowed = true;
+        ctx->jps.tablesStale = true;
+        ctx->jps.hazardsStale = true;
+        ctx->rescuePlan.stale = true;
+        memset(ctx->hpa.clusterStale, true, sizeof(bool) * ctx->hpa.clustersX * ctx->hpa.clustersY);
+    }
+
+    // Returns false if malloc() fails
+    bool InitTileRouter(TileRouter *router, int tilesX, int tilesY) {
+        size_t tiles = (size_t)tilesX * tilesY;
+        router->tilesX = tilesX;
+        router->tilesY = tilesY;
+        router->labels = calloc(tiles, sizeof(uint16_t*));
+        router->regionCount = malloc(sizeof(int) * tiles);
+        router->firstNode = malloc(sizeof(int) * tiles);
+        if (router->labels == NULL || router->regionCount == NULL || router->firstNode == NULL) return false;
+        MarkAllTilesStale(router);
+        return true;
+    }
+
+    void FreeTileRouter(TileRouter *router) {
+        if (router->labels != NULL) {
+            for (int t = 0; t < router->tilesX * router->tilesY; t++) free(router->labels[t]);
+        }
+        free(router->labels);
+        free(router->regionCount);
+        free(router->firstNode);
+        free(router->nodes);
+        free(router->queue.items);
+        free(router->route);
+        *router = (TileRouter){ 0 };
+    }
+
+    size_t TileRouterMemoryUsed(const TileRouter *router) {
+        if (router->labels == NULL) return 0;
+        size_t tiles = (size_t)router->tilesX * router->tilesY;
+        size_t bytes = tiles * (sizeof(uint16_t*) + 2 * sizeof(int));
+        for (size_t t = 0; t < tiles; t++) {
+            if (router->labels[t] != NULL) bytes += sizeof(uint16_t) * WORLD_TILE_SIZE * WORLD_TILE_SIZE;
+        }
+        return bytes + (size_t)router->nodeCapacity * (sizeof(Node) + sizeof(Node*) + sizeof(int));
+    }
+
+    // Both do nothing on an arena the window holds whole, which has no router
+    void MarkAllTilesStale(TileRouter *router) {
+        if (router->labels == NULL) return;
+        for (int t = 0; t < router->tilesX * router->tilesY; t++) router->regionCount[t] = -1;
+        router->stale = true;
+    }
+
+    void MarkTileStale(TileRouter *router, int x, int y) {
+        if (router->labels == NULL) return;
+        router->regionCount[(y >> WORLD_TILE_SHIFT) * router->tilesX + (x >> WORLD_TILE_SHIFT)] = -1;
+        router->stale = true;
+    }
+
+    // Splits one tile into the connected open regions of its cells by flood fill. A tile without
+    // walls is a single region and keeps no labels.
+    static void CountTileRegions(GameContext *ctx, int t) {
+        TileRouter *router = &ctx->router;
+        const WorldTile *tile = ctx->world.directory[t];
+        bool walls = false;
+        for (int i = 0; tile != NULL && i < WORLD_TILE_SIZE * WORLD_TILE_SIZE && !walls; i++) walls = tile->cells[i] == CELL_WALL;
+        if (!walls) {
+            free(router->labels[t]);
+            router->labels[t] = NULL;
+            router->regionCount[t] = 1;
+            return;
+        }
+
+        if (router->labels[t] == NULL) router->labels[t] = malloc(sizeof(uint16_t) * WORLD_TILE_SIZE * WORLD_TILE_SIZE);
+        uint16_t *labels = router->labels[t];
+        if (labels == NULL) {
+            printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+            exit(EXIT_FAILURE);
+        }
+        int width = min(WORLD_TILE_SIZE, ctx->gridWidth - tile->originX);
+        int height = min(WORLD_TILE_SIZE, ctx->gridHeight - tile->originY);
+        memset(labels, 0, sizeof(uint16_t) * WORLD_TILE_SIZE * WORLD_TILE_SIZE);
+        int queue[WORLD_TILE_SIZE * WORLD_TILE_SIZE];
+        int count = 0;
+        for (int seed = 0; seed < WORLD_TILE_SIZE * WORLD_TILE_SIZE; seed++) {
+            if (seed % WORLD_TILE_SIZE >= width || seed / WORLD_TILE_SIZE >= height
+                || labels[seed] != 0 || tile->cells[seed] == CELL_WALL) continue;
+            count++;
+            int head = 0, tail = 0;
+            labels[seed] = (uint16_t)count;
+            queue[tail++] = seed;
+            while (head < tail) {
+                int cell = queue[head++];
+                for (int i = 0; i < 4; i++) {
+                    int nx = cell % WORLD_TILE_SIZE + DIR_VECTORS[i].x;
+                    int ny = cell / WORLD_TILE_SIZE + DIR_VECTORS[i].y;
+                    if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+                    int next = ny * WORLD_TILE_SIZE + nx;
+                    if (labels[next] != 0 || tile->cells[next] == CELL_WALL) continue;
+                    labels[next] = (uint16_t)count;
+                    queue[tail++] = next;
+                }
+            }
+        }
+        router->regionCount[t] = count;
+    }
+
+    // Recounts the stale tiles and renumbers the nodes, which drops the route
+    static void RefreshTileRouter(GameContext *ctx) {
+        TileRouter *router = &ctx->router;
+        if (!router->stale) return;
+        int total = 0;
+        for (int t = 0; t < router->tilesX * router->tilesY; t++) {
+            if (router->regionCount[t] < 0) CountTileRegions(ctx, t);
+            router->firstNode[t] = total;
+            total += router->regionCount[t];
+        }
+        if (total > router->nodeCapacity) {
+            free(router->nodes);
+            free(router->queue.items);
+            free(router->route);
+            router->nodes = malloc(sizeof(Node) * total);
+            router->route = malloc(sizeof(int) * total);
+            if (router->nodes == NULL || router->route == NULL || !InitOpenSet(&router->queue, total)) {
+                printf("\nmalloc() failed. No free space in memory. Program exiting.\n");
+                exit(EXIT_FAILURE);
+            }
+            router->nodeCapacity = total;
+        }
+        router->nodeCount = total;
+        for (int i = 0; i < total; i++) router->nodes[i].generation = 0;
+        router->generation = 0;
+        router->routeLength = 0;
+        router->stale = false;
+    }
+
+    // Node of the region holding world cell (x, y), or -1 for a wall
+    static int TileRegionNode(const GameContext *ctx, int x, int y) {
+        const TileRouter *router = &ctx->router;
+        int t = (y >> WORLD_TILE_SHIFT) * router->tilesX + (x >> WORLD_TILE_SHIFT);
+        const uint16_t *labels = router->labels[t];
+        if (labels == NULL) return router->firstNode[t];
+        int label = labels[(y & (WORLD_TILE_SIZE - 1)) * WORLD_TILE_SIZE + (x & (WORLD_TILE_SIZE - 1))];
+        return label == 0 ? -1 : router->firstNode[t] + label - 1;
+    }
+
+    static void TileRouteRelax(TileRouter *router, Node *from, int toId, int tileX, int tileY, int targetTileX, int targetTileY) {
+        Node *to = &router->nodes[toId];
+        if (to->generation != router->generation) {
+            *to = (Node){tileX, tileY, 9999, 9999, 9999, -1, -1, false, false, -1, router->generation};
+        }
+        if (to->closed) return;
+        int moveCost = from->gCost + 1;
+        if (moveCost < to->gCost || !to->open) {
+            to->gCost = moveCost;
+            to->hCost = GetDistance(tileX, tileY, targetTileX, targetTileY);
+            to->fCost = to->gCost + to->hCost;
+            to->parentX = (int)(from - router->nodes);
+            if (to->open) OpenSetDecreaseKey(&router->queue, to);
+            else OpenSetPush(&router->queue, to);
+            to->open = true;
+        }
+    }
+
+    // A* over (tile, region) nodes, one step per tile crossed, from the region holding world cell
+    // from to the one holding to. Two regions of neighbouring tiles are joined wherever a cell of
+    // one sits against a cell of the other. Fills router->route, returns false if there is no way.
+    static bool FindTileRoute(GameContext *ctx, GridPos from, GridPos to) {
+        TileRouter *router = &ctx->router;
+        router->routeLength = 0;
+        int fromId = TileRegionNode(ctx, from.x, from.y);
+        int toId = TileRegionNode(ctx, to.x, to.y);
+        if (fromId == -1 || toId == -1) return false;
+
+        router->queue.count = 0;
+        router->generation++;
+        if (router->generation == 0) {
+            for (int i = 0; i < router->nodeCount; i++) router->nodes[i].generation = 0;
+            router->generation = 1;
+        }
+        int targetTileX = to.x >> WORLD_TILE_SHIFT;
+        int targetTileY = to.y >> WORLD_TILE_SHIFT;
+        Node *start = &router->nodes[fromId];
+        *start = (Node){from.x >> WORLD_TILE_SHIFT, from.y >> WORLD_TILE_SHIFT, 0, 0, 0, -1, -1, false, true, -1, router->generation};
+        start->hCost = GetDistance(start->x, start->y, targetTileX, targetTileY);
+        start->fCost = start->hCost;
+        OpenSetPush(&router->queue, start);
+
+        Node *goal = NULL;
+        while (goal == NULL) {
+            Node *current = OpenSetPop(&router->queue);
+            if (current == NULL) return false;
+            current->open = false;
+            current->closed = true;
+            int id = (int)(current - router->nodes);
+            if (id == toId) {
+                goal = current;
+                break;
+            }
+
+            int x0 = current->x * WORLD_TILE_SIZE;
+            int y0 = current->y * WORLD_TILE_SIZE;
+            int x1 = min(x0 + WORLD_TILE_SIZE, ctx->gridWidth) - 1;
+            int y1 = min(y0 + WORLD_TILE_SIZE, ctx->gridHeight) - 1;
+            for (int side = 0; side < 4; side++) {
+                int nextTileX = current->x + DIR_VECTORS[side].x;
+                int nextTileY = current->y + DIR_VECTORS[side].y;
+                if (nextTileX < 0 || nextTileX >= router->tilesX || nextTileY < 0 || nextTileY >= router->tilesY) continue;
+                bool across = side == NORTH || side == SOUTH; // The border runs along x
+                int length = across ? x1 - x0 + 1 : y1 - y0 + 1;
+                for (int pos = 0; pos < length; pos++) {
+                    int x = across ? x0 + pos : (side == EAST ? x1 : x0);
+                    int y = across ? (side == SOUTH ? y1 : y0) : y0 + pos;
+                    if (TileRegionNode(ctx, x, y) != id) continue;
+                    int next = TileRegionNode(ctx, x + DIR_VECTORS[side].x, y + DIR_VECTORS[side].y);
+                    if (next != -1) TileRouteRelax(router, current, next, nextTileX, nextTileY, targetTileX, targetTileY);
+                }
+            }
+        }
+
+        // Trace back from the target's region, then flip so the robot's comes first
+        for (Node *node = goal; ; node = &router->nodes[node->parentX]) {
+            router->route[router->routeLength++] = (int)(node - router->nodes);
+            if (node->parentX == -1) break;
+        }
+        for (int i = 0; i < router->routeLength / 2; i++) {
+            int swap = router->route[i];
+            router->route[i] = router->route[router->routeLength - 1 - i];
+            router->route[router->routeLength - 1 - i] = swap;
+        }
+        return true;
+    }
+
+    // Whether the window holds every cell of a route node's tile
+    static bool TileInsideWindow(const GameContext *ctx, const Node *node) {
+        const PlanningWindow *window = &ctx->window;
+        int x0 = node->x * WORLD_TILE_SIZE;
+        int y0 = node->y * WORLD_TILE_SIZE;
+        return x0 >= window->originX && min(x0 + WORLD_TILE_SIZE, ctx->gridWidth) <= window->originX + window->width
+            && y0 >= window->originY && min(y0 + WORLD_TILE_SIZE, ctx->gridHeight) <= window->originY + window->height;
+    }
+
+    // Where the planners should head for target (a world cell, {-1, -1} for none), as a window
+    // cell: the target itself if the window holds it, otherwise a cell of the furthest region along
+    // the tile route that the window reaches without leaving it first. {-1, -1} if there is no way.
+    GridPos GetWindowGoal(GameContext *ctx, GridPos target) {
+        ctx->window.targetOutside = false;
+        if (target.x == -1) return target;
+        GridPos goal = WorldToWindow(ctx, target);
+        if (IsInsideWindow(ctx, goal.x, goal.y)) return goal;
+        ctx->window.targetOutside = true;
+
+        TileRouter *router = &ctx->router;
+        RefreshTileRouter(ctx);
+        // The route so far still does if it ends at the target's region and passes through the window,
+        // ideally from the robot's region. Otherwise route again from the robot.
+        int robotId = TileRegionNode(ctx, ctx->robot.position.x, ctx->robot.position.y);
+        int from = -1;
+        if (router->routeLength > 0 && router->route[router->routeLength - 1] == TileRegionNode(ctx, target.x, target.y)) {
+            for (int i = 0; i < router->routeLength && from == -1; i++) {
+                if (router->route[i] == robotId) from = i;
+            }
+            for (int i = 0; i < router->routeLength && from == -1; i++) {
+                if (TileInsideWindow(ctx, &router->nodes[router->route[i]])) from = i;
+            }
+        }
+        if (from == -1) {
+            if (!FindTileRoute(ctx, ctx->robot.position, target)) return (GridPos){-1, -1};
+            from = 0;
+        }
+        int last = from;
+        while (last + 1 < router->routeLength && TileInsideWindow(ctx, &router->nodes[router->route[last + 1]])) last++;
+        if (last + 1 == router->routeLength) return (GridPos){-1, -1}; // Only if the route is out of date
+
+        // The cell of that region nearest the middle of the next tile along, other than the respawn point
+        int id = router->route[last];
+        const Node *node = &router->nodes[id];
+        const Node *next = &router->nodes[router->route[last + 1]];
+        int aimX = next->x * WORLD_TILE_SIZE + WORLD_TILE_SIZE / 2;
+        int aimY = next->y * WORLD_TILE_SIZE + WORLD_TILE_SIZE / 2;
+        GridPos spawn = GetRobotSpawn(ctx);
+        GridPos best = {-1, -1};
+        int bestDistance = 0;
+        for (int y = node->y * WORLD_TILE_SIZE; y < min((node->y + 1) * WORLD_TILE_SIZE, ctx->gridHeight); y++) {
+            for (int x = node->x * WORLD_TILE_SIZE; x < min((node->x + 1) * WORLD_TILE_SIZE, ctx->gridWidth); x++) {
+                if (TileRegionNode(ctx, x, y) != id || (x == spawn.x && y == spawn.y)) continue;
+                int distance = GetDistance(x, y, aimX, aimY);
+                if (best.x == -1 || distance < bestDistance) {
+                    best = (GridPos){x, y};
+                    bestDistance = distance;
+                }
+            }
+        }
+        return best.x == -1 ? best : WorldToWindow(ctx, best);
+    }
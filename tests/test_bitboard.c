@@ -0,0 +1,149 @@
+// Bitboard Tests
+// Runs the dilation kernel the AI uses for mine proximity on random boards and checks every cell
+// against brute-force scans: the 8-neighbour scan for "next to a mine" and the (2r+1)^2 window
+// scan for the safety score. Also checks the word-wide neighbour masks against testing cells one
+// by one. Widths over 64 cover the rows that span several words, where bits are carried between them.
+// Includes
+    #include "bitboard.h"
+    #include <stdio.h>
+    #include <stdlib.h>
+
+//--------------------------------------------------------------------------------------
+// Constants & Definitions
+//--------------------------------------------------------------------------------------
+    #define MINE 3
+    #define SAFETY_RADIUS 4 // MINE_SAFETY_RADIUS in game.c
+    #define BOARDS_PER_SIZE 16
+
+//--------------------------------------------------------------------------------------
+// Queries, as game.c makes them
+//--------------------------------------------------------------------------------------
+    static bool LevelsIsNearMine(const Bitboard *chebyshev, int x, int y) {
+        return BitboardTest(&chebyshev[1], x, y);
+    }
+
+    static int LevelsSafetyScore(const Bitboard *chebyshev, const Bitboard *manhattan, int x, int y) {
+        if (!BitboardTest(&chebyshev[SAFETY_RADIUS], x, y)) return 999;
+        int distance = 0;
+        while (!BitboardTest(&manhattan[distance], x, y)) distance++;
+        return distance;
+    }
+
+//--------------------------------------------------------------------------------------
+// Brute-Force References
+//--------------------------------------------------------------------------------------
+    static bool ScanIsNearMine(const int *grid, int width, int height, int x, int y) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx == 0 && dy == 0) continue;
+                int nx = x + dx, ny = y + dy;
+                if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+                if (grid[ny*width + nx] == MINE) return true;
+            }
+        }
+        return false;
+    }
+
+    // Closest mine by Manhattan distance inside the (2*window+1)^2 square, or 999 if it holds none
+    static int ScanSafetyScore(const int *grid, int width, int height, int x, int y, int window) {
+        int best = 999;
+        for (int ny = y - window; ny <= y + window; ny++) {
+            for (int nx = x - window; nx <= x + window; nx++) {
+                if (nx < 0 || ny < 0 || nx >= width || ny >= height || grid[ny*width + nx] != MINE) continue;
+                int distance = abs(nx - x) + abs(ny - y);
+                if (distance < best) best = distance;
+            }
+        }
+        return best;
+    }
+
+    // The neighbour mask the slow way, one cell at a time
+    static int ScanNeighbourMask(const Bitboard *a, const Bitboard *b, int x, int y) {
+        int dx[] = {0, 1, 0, -1};
+        int dy[] = {-1, 0, 1, 0};
+        int mask = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d], ny = y + dy[d];
+            if (nx < 0 || ny < 0 || nx >= a->width || ny >= a->height
+                || BitboardTest(a, nx, ny) || BitboardTest(b, nx, ny)) mask |= 1 << d;
+        }
+        return mask;
+    }
+
+//--------------------------------------------------------------------------------------
+// Main Entry Point
+//--------------------------------------------------------------------------------------
+    int main(void) {
+        int sizes[][2] = {{10, 10}, {30, 30}, {63, 9}, {64, 20}, {65, 17}, {128, 12}, {130, 33}, {200, 7}};
+        int densities[] = {0, 1, 4, 25}; // Mines per 100 cells
+        int failures = 0;
+        int closerOutside = 0;
+        srand(4242);
+
+        for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+            int width = sizes[s][0], height = sizes[s][1];
+            int *grid = malloc(sizeof(int) * width * height);
+            Bitboard mines, walls;
+            Bitboard chebyshev[SAFETY_RADIUS + 1];
+            Bitboard manhattan[2 * SAFETY_RADIUS + 1];
+            bool allocated = grid != NULL && InitBitboard(&mines, width, height) && InitBitboard(&walls, width, height);
+            for (int k = 0; k <= SAFETY_RADIUS; k++) allocated = allocated && InitBitboard(&chebyshev[k], width, height);
+            for (int k = 0; k <= 2 * SAFETY_RADIUS; k++) allocated = allocated && InitBitboard(&manhattan[k], width, height);
+            if (!allocated) {
+                printf("malloc() failed.\n");
+                return EXIT_FAILURE;
+            }
+
+            for (int b = 0; b < BOARDS_PER_SIZE; b++) {
+                int density = densities[b % 4];
+                ClearBitboard(&mines);
+                ClearBitboard(&walls);
+                for (int i = 0; i < width*height; i++) {
+                    grid[i] = (rand() % 100 < density) ? MINE : rand() % 3;
+                    if (grid[i] == MINE) BitboardSet(&mines, i % width, i / width);
+                    if (grid[i] == 1) BitboardSet(&walls, i % width, i / width);
+                }
+                BitboardDistanceLevels(&mines, chebyshev, SAFETY_RADIUS + 1, true);
+                BitboardDistanceLevels(&mines, manhattan, 2 * SAFETY_RADIUS + 1, false);
+
+                for (int y = 0; y < height; y++) {
+                    for (int x = 0; x < width; x++) {
+                        int mask = BitboardNeighbourMask(&walls, &mines, x, y);
+                        if (mask != ScanNeighbourMask(&walls, &mines, x, y) && failures++ < 10) {
+                            printf("Neighbour mask at (%d, %d) on a %dx%d board: %d, cell by cell %d\n",
+                                   x, y, width, height, mask, ScanNeighbourMask(&walls, &mines, x, y));
+                        }
+                        // The levels count a mine's own cell as near, the scan never looks at it
+                        bool near = LevelsIsNearMine(chebyshev, x, y);
+                        bool expectedNear = grid[y*width + x] == MINE || ScanIsNearMine(grid, width, height, x, y);
+                        if (near != expectedNear && failures++ < 10) {
+                            printf("(%d, %d) on a %dx%d board: near %d, scan says %d\n", x, y, width, height, near, expectedNear);
+                        }
+                        int score = LevelsSafetyScore(chebyshev, manhattan, x, y);
+                        int expected = ScanSafetyScore(grid, width, height, x, y, SAFETY_RADIUS);
+                        // With only corner mines in the window, a closer mine just outside it is the
+                        // one reported. Any such mine is within twice the radius.
+                        int closest = ScanSafetyScore(grid, width, height, x, y, 2 * SAFETY_RADIUS);
+                        if (expected != 999 && closest < expected && score == closest) {
+                            closerOutside++;
+                        } else if (score != expected && failures++ < 10) {
+                            printf("(%d, %d) on a %dx%d board: score %d, scan says %d\n", x, y, width, height, score, expected);
+                        }
+                    }
+                }
+            }
+
+            FreeBitboard(&mines);
+            FreeBitboard(&walls);
+            for (int k = 0; k <= SAFETY_RADIUS; k++) FreeBitboard(&chebyshev[k]);
+            for (int k = 0; k <= 2 * SAFETY_RADIUS; k++) FreeBitboard(&manhattan[k]);
+            free(grid);
+        }
+
+        if (failures > 0) {
+            printf("test_bitboard: %d mismatches\n", failures);
+            return EXIT_FAILURE;
+        }
+        printf("test_bitboard: passed (%d scores took a closer mine outside the window)\n", closerOutside);
+        return EXIT_SUCCESS;
+    }
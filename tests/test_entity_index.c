@@ -0,0 +1,94 @@
+// Entity Index Tests
+// Inserts, moves and removes entities at random and checks after every operation that each
+// cell finds exactly what a plain array of cells says stands there. Cells are drawn from a small
+// range on a table sized for many entries so probe runs collide and wrap around the end of the
+// table, which is where backward-shift removal can go wrong.
+// Includes
+    #include "entity_index.h"
+    #include <stdio.h>
+    #include <stdlib.h>
+
+//--------------------------------------------------------------------------------------
+// Constants & Definitions
+//--------------------------------------------------------------------------------------
+    #define ROUNDS 40
+    #define STEPS_PER_ROUND 4000
+
+//--------------------------------------------------------------------------------------
+// Checks
+//--------------------------------------------------------------------------------------
+    // Every cell must find what the reference holds, and the count must match its entries
+    static int CheckAgainstReference(const EntityIndex *index, const int *reference, int cellCount) {
+        int mismatches = 0;
+        int entries = 0;
+        for (int cell = 0; cell < cellCount; cell++) {
+            if (reference[cell] != ENTITY_INDEX_NONE) entries++;
+            int found = EntityIndexFind(index, cell);
+            if (found != reference[cell] && mismatches++ < 5) {
+                printf("Cell %d finds %d, expected %d\n", cell, found, reference[cell]);
+            }
+        }
+        if (entries != index->count && mismatches++ < 5) {
+            printf("Index counts %d entries, expected %d\n", index->count, entries);
+        }
+        return mismatches;
+    }
+
+//--------------------------------------------------------------------------------------
+// Main Entry Point
+//--------------------------------------------------------------------------------------
+    int main(void) {
+        int failures = 0;
+        srand(2024);
+
+        for (int round = 0; round < ROUNDS; round++) {
+            int maxEntities = 1 + rand() % 64;
+            // Few spare cells keeps the table near its sized load, many spreads the keys out
+            int cellCount = maxEntities + rand() % (round % 2 == 0 ? 8 : 100000);
+            int *reference = malloc(sizeof(int) * cellCount);
+            EntityIndex index;
+            if (reference == NULL || !InitEntityIndex(&index, maxEntities)) {
+                printf("malloc() failed.\n");
+                return EXIT_FAILURE;
+            }
+            for (int cell = 0; cell < cellCount; cell++) reference[cell] = ENTITY_INDEX_NONE;
+            int entries = 0;
+
+            for (int step = 0; step < STEPS_PER_ROUND && failures == 0; step++) {
+                int cell = rand() % cellCount;
+                int action = rand() % 3;
+                if (reference[cell] == ENTITY_INDEX_NONE && entries < maxEntities && action != 2) {
+                    int entity = rand() % 1000;
+                    EntityIndexInsert(&index, cell, entity);
+                    reference[cell] = entity;
+                    entries++;
+                } else if (reference[cell] != ENTITY_INDEX_NONE && action == 0) {
+                    // Overwriting an entry, as the game does when an entity is re-indexed
+                    int entity = rand() % 1000;
+                    EntityIndexInsert(&index, cell, entity);
+                    reference[cell] = entity;
+                } else {
+                    // Removing a cell that holds nothing must leave the table alone
+                    if (reference[cell] != ENTITY_INDEX_NONE) entries--;
+                    EntityIndexRemove(&index, cell);
+                    reference[cell] = ENTITY_INDEX_NONE;
+                }
+                // The full check is O(cells), so only every step while the range is small
+                if (cellCount < 1000 || step % 97 == 0) failures += CheckAgainstReference(&index, reference, cellCount);
+            }
+
+            ClearEntityIndex(&index);
+            for (int cell = 0; cell < cellCount; cell++) reference[cell] = ENTITY_INDEX_NONE;
+            failures += CheckAgainstReference(&index, reference, cellCount);
+
+            FreeEntityIndex(&index);
+            free(reference);
+        }
+
+        if (failures > 0) {
+            printf("test_entity_index: %d mismatches\n", failures);
+            return EXIT_FAILURE;
+        }
+        printf("test_entity_index: passed\n");
+        return EXIT_SUCCESS;
+    }
@@ -0,0 +1,64 @@
+// Spawn Route Tests
+// The robot may never step onto its respawn point, so a planner that routes through it leaves
+// the robot pushing against it until something else moves. Every planner plays the arena where
+// that used to happen, and the test fails if the AI ever steers into the respawn point.
+// Unlike the other tests this one builds the whole game, so it needs raylib like the game does.
+// Includes
+    #define main GameMain
+    #include "game.c"
+    #undef main
+
+//--------------------------------------------------------------------------------------
+// Constants & Definitions
+//--------------------------------------------------------------------------------------
+    #define TEST_GRID_WIDTH 130
+    #define TEST_GRID_HEIGHT 70
+    #define TEST_SEED 9
+    #define TEST_LEVELS 4
+    #define TEST_TICK_LIMIT 40000 // Every planner clears the four levels in about half of this
+
+//--------------------------------------------------------------------------------------
+// Main Entry Point
+//--------------------------------------------------------------------------------------
+    int main(void) {
+        int failures = 0;
+
+        for (int p = 0; p < PLANNER_COUNT; p++) {
+            GameContext *ctx = calloc(1, sizeof(GameContext));
+            if (ctx == NULL) {
+                printf("malloc() failed.\n");
+                return EXIT_FAILURE;
+            }
+            InitGame(ctx, TEST_GRID_WIDTH, TEST_GRID_HEIGHT, TEST_SEED);
+            ctx->baseTickRate = DEFAULT_TICK_RATE;
+            ctx->tickRate = DEFAULT_TICK_RATE;
+            ctx->planner = (PathPlanner)p;
+            BeginHeadlessGame(ctx);
+
+            // A move the AI chose that left the robot in place, facing the respawn point
+            int stalls = 0;
+            GridPos spawn = GetRobotSpawn(ctx);
+            while (ctx->currentState == STATE_PLAYING && ctx->currentLevel <= TEST_LEVELS && ctx->tickCount < TEST_TICK_LIMIT) {
+                GridPos before = ctx->robot.position;
+                StepGameplay(ctx);
+                GridPos ahead = {before.x + DIR_VECTORS[ctx->robot.direction].x, before.y + DIR_VECTORS[ctx->robot.direction].y};
+                if (ctx->robot.position.x == before.x && ctx->robot.position.y == before.y
+                    && ahead.x == spawn.x && ahead.y == spawn.y) stalls++;
+            }
+
+            if (stalls > 0) {
+                printf("%s: %d ticks facing the respawn point, %d ticks to level %d\n",
+                       plannerNames[p], stalls, ctx->tickCount, ctx->currentLevel);
+                failures++;
+            }
+            FreeGame(ctx);
+            free(ctx);
+        }
+
+        if (failures > 0) {
+            printf("test_spawn_routes: %d planners ran into the respawn point\n", failures);
+            return EXIT_FAILURE;
+        }
+        printf("test_spawn_routes: passed\n");
+        return EXIT_SUCCESS;
+    }
@@ -0,0 +1,95 @@
+// Includes
+    #include "world.h"
+    #include <stdlib.h>
+    #include <string.h>
+
+//--------------------------------------------------------------------------------------
+// Lifetime
+//--------------------------------------------------------------------------------------
+    bool InitWorld(World *world, int width, int height) {
+        world->width = width;
+        world->height = height;
+        world->tilesX = (width + WORLD_TILE_SIZE - 1) / WORLD_TILE_SIZE;
+        world->tilesY = (height + WORLD_TILE_SIZE - 1) / WORLD_TILE_SIZE;
+        world->populatedCount = 0;
+        world->allocatedCount = 0;
+        world->spare = NULL;
+        size_t tiles = (size_t)world->tilesX * world->tilesY;
+        world->directory = calloc(tiles, sizeof(WorldTile*));
+        world->populated = malloc(tiles * sizeof(WorldTile*));
+        if (world->directory == NULL || world->populated == NULL) {
+            FreeWorld(world);
+            return false;
+        }
+        return true;
+    }
+
+    void FreeWorld(World *world) {
+        for (int i = 0; i < world->populatedCount; i++) free(world->populated[i]);
+        while (world->spare != NULL) {
+            WorldTile *next = world->spare->nextSpare;
+            free(world->spare);
+            world->spare = next;
+        }
+        free(world->directory);
+        free(world->populated);
+        world->directory = NULL;
+        world->populated = NULL;
+        world->populatedCount = 0;
+        world->allocatedCount = 0;
+    }
+
+//--------------------------------------------------------------------------------------
+// Tiles
+//--------------------------------------------------------------------------------------
+    static WorldTile* AcquireTile(World *world, int tileIndex) {
+        WorldTile *tile = world->spare;
+        if (tile != NULL) {
+            world->spare = tile->nextSpare;
+        } else {
+            tile = malloc(sizeof(WorldTile));
+            if (tile == NULL) return NULL;
+            world->allocatedCount++;
+        }
+        memset(tile->cells, WORLD_EMPTY_CELL, sizeof(tile->cells));
+        tile->originX = (tileIndex % world->tilesX) * WORLD_TILE_SIZE;
+        tile->originY = (tileIndex / world->tilesX) * WORLD_TILE_SIZE;
+        tile->occupied = 0;
+        tile->listSlot = world->populatedCount;
+        tile->nextSpare = NULL;
+        world->populated[world->populatedCount++] = tile;
+        world->directory[tileIndex] = tile;
+        return tile;
+    }
+
+    static void ReleaseTile(World *world, int tileIndex) {
+        WorldTile *tile = world->directory[tileIndex];
+        // Swap the last populated tile into the freed slot
+        WorldTile *last = world->populated[--world->populatedCount];
+        world->populated[tile->listSlot] = last;
+        last->listSlot = tile->listSlot;
+        world->directory[tileIndex] = NULL;
+        tile->nextSpare = world->spare;
+        world->spare = tile;
+    }
+
+    bool WorldSet(World *world, int x, int y, int value) {
+        int tileIndex = (y >> WORLD_TILE_SHIFT) * world->tilesX + (x >> WORLD_TILE_SHIFT);
+        WorldTile *tile = world->directory[tileIndex];
+        if (tile == NULL) {
+            if (value == WORLD_EMPTY_CELL) return true;
+            tile = AcquireTile(world, tileIndex);
+            if (tile == NULL) return false;
+        }
+
+        unsigned char *cell = &tile->cells[(y & (WORLD_TILE_SIZE - 1)) * WORLD_TILE_SIZE + (x & (WORLD_TILE_SIZE - 1))];
+        tile->occupied += (value != WORLD_EMPTY_CELL) - (*cell != WORLD_EMPTY_CELL);
+        *cell = (unsigned char)value;
+        if (tile->occupied == 0) ReleaseTile(world, tileIndex);
+        return true;
+    }
+
+    size_t WorldMemoryUsed(const World *world) {
+        size_t tiles = (size_t)world->tilesX * world->tilesY;
+        return tiles * 2 * sizeof(WorldTile*) + (size_t)world->allocatedCount * sizeof(WorldTile);
+    }
@@ -0,0 +1,50 @@
+// Chunked World
+// The arena's cells, kept in square tiles that are only allocated once a non-empty value is
+// written into them. A directory with one pointer per tile keeps lookups O(1), and a list of the
+// populated tiles lets callers walk the content of a huge, mostly empty arena without visiting
+// the empty parts.
+#ifndef WORLD_H
+#define WORLD_H
+
+    #include <stdbool.h>
+    #include <stddef.h>
+
+    #define WORLD_TILE_SHIFT 5
+    #define WORLD_TILE_SIZE (1 << WORLD_TILE_SHIFT) // Cells per tile side
+    #define WORLD_EMPTY_CELL 0 // Value of every cell in a tile that was never allocated
+
+    typedef struct WorldTile {
+        unsigned char cells[WORLD_TILE_SIZE * WORLD_TILE_SIZE]; // Row-major within the tile
+        int originX, originY; // World coordinates of cells[0]
+        int occupied; // Non-empty cells, the tile goes back to the spare list when this reaches 0
+        int listSlot; // Index in World.populated
+        struct WorldTile *nextSpare;
+    } WorldTile;
+
+    typedef struct {
+        int width, height;
+        int tilesX, tilesY;
+        WorldTile **directory; // tilesX * tilesY, row-major, NULL where every cell is empty
+        WorldTile **populated; // The non-NULL directory entries, in no particular order
+        int populatedCount;
+        WorldTile *spare; // Emptied tiles kept for reuse, so entities crossing tile edges never hit malloc()
+        int allocatedCount; // Populated and spare tiles
+    } World;
+
+    // Allocates the tile directory for a width x height arena with every cell empty. Returns false if malloc() fails.
+    bool InitWorld(World *world, int width, int height);
+    void FreeWorld(World *world);
+
+    static inline int WorldGet(const World *world, int x, int y) {
+        const WorldTile *tile = world->directory[(y >> WORLD_TILE_SHIFT) * world->tilesX + (x >> WORLD_TILE_SHIFT)];
+        if (tile == NULL) return WORLD_EMPTY_CELL;
+        return tile->cells[(y & (WORLD_TILE_SIZE - 1)) * WORLD_TILE_SIZE + (x & (WORLD_TILE_SIZE - 1))];
+    }
+
+    // Writes one cell (value 0..255), allocating or releasing its tile as needed. Returns false if malloc() fails.
+    bool WorldSet(World *world, int x, int y, int value);
+
+    // Bytes held by the directory and every allocated tile, spares included
+    size_t WorldMemoryUsed(const World *world);
+
+#endif